@@ -1,7 +1,17 @@
 #pragma once
+#include "search-stats.h"
+
 class Agent {
 public:
     Agent() {}
     virtual ~Agent() {}
     virtual int getAgentMove() = 0;
+
+    // Statistics of the last getAgentMove, for agents that keep them
+    virtual bool getSearchStats(SearchStats&) { return false; }
+
+    // Search in the background while the opponent decides on their move, for agents that can
+    // reuse the work; stopPondering returns once the background search has finished
+    virtual void startPondering() {}
+    virtual void stopPondering() {}
 };
\ No newline at end of file
@@ -0,0 +1,33 @@
+// 
+// alloc-counter.cpp
+// Jake Buhite and Nick Abegg
+// 10/26/2023
+//
+#include "alloc-counter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef C4_ALLOCATION_COUNTER
+static std::atomic<long long> allocations(0);
+static thread_local long long allocationsOfThread = 0;
+
+void* operator new(size_t size) {
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	allocationsOfThread++;
+	if (void* memory = std::malloc(size ? size : 1)) return memory;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+
+long long totalAllocations() { return allocations.load(); }
+
+long long threadAllocations() { return allocationsOfThread; }
+#else
+long long totalAllocations() { return 0; }
+
+long long threadAllocations() { return 0; }
+#endif
@@ -0,0 +1,18 @@
+// 
+// alloc-counter.h
+// Jake Buhite and Nick Abegg
+// 10/26/2023
+//
+#pragma once
+
+// Debug builds (and builds defining C4_COUNT_ALLOCATIONS) replace the global operator new
+// with one that counts heap allocations, so code that must not allocate can assert it
+#if !defined(NDEBUG) || defined(C4_COUNT_ALLOCATIONS)
+#define C4_ALLOCATION_COUNTER
+#endif
+
+// Heap allocations made so far by the whole process (0 without the counter)
+long long totalAllocations();
+
+// Heap allocations made so far by the calling thread (0 without the counter)
+long long threadAllocations();
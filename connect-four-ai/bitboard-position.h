@@ -0,0 +1,38 @@
+// 
+// bitboard-position.h
+// Jake Buhite and Nick Abegg
+// 10/26/2023
+//
+#pragma once
+#include <cstdint>
+
+// Position of the searches that play moves by value (Solver and MCTS), in Connect4's
+// bitboard layout: bit col * (rows + 1) + height from the bottom
+struct BitboardPosition {
+	uint64_t current; // Discs of the player to move
+	uint64_t mask;
+	int moves;
+};
+
+// Move generation on BitboardPositions of one board size
+class BitboardMoves {
+private:
+	int rows;
+	uint64_t bottomMask = 0; // Lowest cell of every column
+	uint64_t boardMask = 0;
+public:
+	BitboardMoves(int rows, int cols) : rows(rows) {
+		for (int i = 0; i < cols; i++) {
+			bottomMask |= (uint64_t)1 << (i * (rows + 1));
+			boardMask |= columnMask(i);
+		}
+	}
+
+	// The opponent becomes the player to move
+	static BitboardPosition play(const BitboardPosition& p, uint64_t move) { return { p.current ^ p.mask, p.mask | move, p.moves + 1 }; }
+
+	// The playable cell of every column that is not full
+	uint64_t possible(const BitboardPosition& p) const { return (p.mask + bottomMask) & boardMask; }
+	uint64_t columnMask(int col) const { return (((uint64_t)1 << rows) - 1) << (col * (rows + 1)); }
+	uint64_t getBoardMask() const { return boardMask; }
+};
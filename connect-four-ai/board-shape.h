@@ -0,0 +1,50 @@
+// 
+// board-shape.h
+// Jake Buhite and Nick Abegg
+// 10/26/2023
+//
+#pragma once
+#include <cstdint>
+
+// Board sizes with a compile-time specialisation; Connect4 picks one at construction
+// and uses its runtime-sized code for any other size chosen in main
+enum BoardSize { SIZE_CUSTOM = 0, SIZE_6X7 = 1 };
+
+// Bitboard geometry of a rows x cols board known at compile time, so the loops over
+// columns and line directions unroll into constant shifts and masks
+template <int Rows, int Cols>
+struct BoardShape {
+	static constexpr int HEIGHT = Rows + 1;
+	static constexpr uint64_t COLUMN = ((uint64_t)1 << Rows) - 1;
+
+	static constexpr uint64_t boardMask() {
+		uint64_t mask = 0;
+		for (int i = 0; i < Cols; i++)
+			mask |= COLUMN << (i * HEIGHT);
+		return mask;
+	}
+
+	// Four in a row horizontally, on both diagonals or vertically
+	static bool alignment(uint64_t pos) {
+		return line<HEIGHT>(pos) || line<HEIGHT - 1>(pos) || line<HEIGHT + 1>(pos) || line<1>(pos);
+	}
+
+	// Swaps columns left to right; keys never carry across columns
+	static uint64_t mirror(uint64_t key) {
+		const uint64_t column = ((uint64_t)1 << HEIGHT) - 1;
+		uint64_t mirrored = 0;
+		for (int i = 0; i < Cols; i++)
+			mirrored |= ((key >> (i * HEIGHT)) & column) << ((Cols - 1 - i) * HEIGHT);
+		return mirrored;
+	}
+
+private:
+	template <int Shift>
+	static bool line(uint64_t pos) {
+		// No four in a row fits in this direction
+		constexpr int shift = (3 * Shift < 64) ? Shift : 0;
+		if (shift == 0) return false;
+		uint64_t m = pos & (pos >> shift);
+		return (m & (m >> (2 * shift))) != 0;
+	}
+};
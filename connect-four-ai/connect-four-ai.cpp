@@ -4,18 +4,121 @@
 // 10/26/2023
 //
 #include "connect-four.h"
+#include "engine.h"
+#include "game-record.h"
+#include "mcts.h"
 #include "minimax.h"
+#include "opening-book.h"
+#include "tablebase.h"
+#include "solver.h"
 #include "tdl-agent.h"
+#include "tournament.h"
 
 void beginPvP(Connect4* game);
-void beginPvA(Connect4* game, MiniMax* agent, int playerTurn);
-void beginAvA(Connect4* game, MiniMax* agent1, MiniMax* agent2);
-int beginTvT(Connect4* game, TDLAgent* agent1, TDLAgent* agent2);
+void beginPvA(Connect4* game, Agent* agent, int playerTurn, std::ostream* statsLog = nullptr, GameRecordWriter* records = nullptr);
+void beginAvA(Connect4* game, Agent* agent1, Agent* agent2, std::ostream* statsLog = nullptr, GameRecordWriter* records = nullptr);
+void logSearchStats(std::ostream* statsLog, Connect4* game, Agent* agent);
+int beginTvT(Connect4* game, TDLAgent* agent1, TDLAgent* agent2, GameRecordWriter* records = nullptr);
 int beginMvT(Connect4* game, TDLAgent* agent1, Agent* ref);
-void trainTDL();
+MCTS* createMCTS(Connect4* game, Actor player, int threads, TDLAgent* valueAgents[2], Tablebase* tablebase);
+void trainTDL(int threads, double lambda, GameRecordWriter* records, Tablebase* tablebase);
+void trainWorker(TDLAgent* shared1, TDLAgent* shared2, double initialAlpha, double initialEpsilon, double lambda,
+	std::atomic<int>* trainingGames, int target, unsigned int seed, GameRecordWriter* records, Tablebase* tablebase);
+int summarizeGames(const std::string& fileName);
 
-int main()
+int main(int argc, char* argv[])
 {
+	// Offline opening book generation: --generate-book <plies> [file]
+	if (argc >= 3 && std::string(argv[1]) == "--generate-book") {
+		std::string bookFile = (argc >= 4) ? argv[3] : "book.bin";
+		return OpeningBook::generate(bookFile, std::stoi(argv[2]), 6, 7) ? 0 : 1;
+	}
+
+	// Offline endgame tablebase generation, from the positions the games of a record file reach
+	// or from the empty board: --generate-tablebase <empty cells> <file> (<games file> | <rows> <cols>)
+	if (argc >= 5 && std::string(argv[1]) == "--generate-tablebase") {
+		if (argc >= 6) return Tablebase::generate(argv[3], std::stoi(argv[2]), std::stoi(argv[4]), std::stoi(argv[5])) ? 0 : 1;
+		GameRecordReader games;
+		if (!games.open(argv[4])) return 1;
+		return Tablebase::generate(argv[3], std::stoi(argv[2]), games.getRows(), games.getCols(), argv[4]) ? 0 : 1;
+	}
+
+	// One-shot weight conversion: --convert-weights <weights.txt> <weights.bin>
+	if (argc >= 4 && std::string(argv[1]) == "--convert-weights")
+		return TDLAgent::convertWeights(argv[2], argv[3]) ? 0 : 1;
+
+	// Inference-only weights: --quantize-weights <weights.bin> <out.bin> <int16|float16>
+	if (argc >= 5 && std::string(argv[1]) == "--quantize-weights") {
+		WeightType type = (std::string(argv[4]) == "float16") ? WEIGHT_FLOAT16 : WEIGHT_INT16;
+		return TDLAgent::quantizeWeights(argv[2], argv[3], type) ? 0 : 1;
+	}
+
+	// Self-play training of the TDL agents, optionally recording every game: --train [threads] [lambda] [records]
+	if (argc >= 2 && std::string(argv[1]) == "--train") {
+		GameRecordWriter records;
+		if (argc >= 5 && !records.open(argv[4], 6, 7)) return 1;
+		Tablebase tablebase;
+		tablebase.load("tablebase.bin");
+		trainTDL((argc >= 3) ? std::stoi(argv[2]) : 1, (argc >= 4) ? std::stod(argv[3]) : 0, (argc >= 5) ? &records : nullptr, &tablebase);
+		return 0;
+	}
+
+	// Totals of a game record file: --read-games <file>
+	if (argc >= 3 && std::string(argv[1]) == "--read-games")
+		return summarizeGames(argv[2]);
+
+	// Headless round robin on the standard board: --tournament <games per pairing> <threads> <agent>...
+	if (argc >= 6 && std::string(argv[1]) == "--tournament") {
+		Tablebase tablebase;
+		tablebase.load("tablebase.bin");
+		Tournament tournament(6, 7);
+		tournament.setTablebase(&tablebase);
+		for (int i = 4; i < argc; i++)
+			if (!tournament.addEntrant(argv[i])) return 1;
+		tournament.run(std::stoi(argv[2]), std::stoi(argv[3]));
+		tournament.printResults();
+		return 0;
+	}
+
+	// Long running engine protocol over stdin/stdout: --engine
+	if (argc >= 2 && std::string(argv[1]) == "--engine") {
+		// Messages of the loaders go to stderr so that stdout only carries the protocol
+		std::ostream protocol(std::cout.rdbuf());
+		std::cout.rdbuf(std::cerr.rdbuf());
+		OpeningBook book;
+		book.load("book.bin");
+		Tablebase tablebase;
+		tablebase.load("tablebase.bin");
+		{
+			Engine engine(protocol, &book, &tablebase);
+			engine.loadWeights("weights1.bin", "weights2.bin");
+			engine.run(std::cin);
+		}
+		std::cout.rdbuf(protocol.rdbuf());
+		return 0;
+	}
+
+	// Per-move search statistics as JSON lines: --stats-log <file>
+	// Every finished game appended to a game record file: --record-games <file>
+	std::ofstream statsFile;
+	std::ostream* statsLog = nullptr;
+	std::string recordFile;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		std::string option = argv[i];
+		if (option == "--stats-log") {
+			statsFile.open(argv[i + 1], std::ios::app);
+			if (statsFile.is_open()) statsLog = &statsFile;
+			else std::cout << "Unable to open " << argv[i + 1] << " for search statistics" << std::endl;
+		}
+		else if (option == "--record-games") recordFile = argv[i + 1];
+	}
+	GameRecordWriter recordWriter;
+
+	OpeningBook book;
+	book.load("book.bin");
+	Tablebase tablebase;
+	tablebase.load("tablebase.bin");
+
 	int rows = -1;
 	int cols = -1;
 	int depth = 8;
@@ -23,6 +126,8 @@ int main()
 	char endGame = 'n';
 	int choice = 0;
 	int playerTurn = 0;
+	int moveTime = 0;
+	int threads = 1;
 	while (true) {
 		std::cout << "Please enter the number of rows: ";
 		std::cin >> rows;
@@ -30,15 +135,27 @@ int main()
 		std::cout << "Please enter the number of cols: ";
 		std::cin >> cols;
 
+		if (!Connect4::fitsBitboard(rows, cols)) {
+			std::cout << "ERROR: The board must satisfy cols * (rows + 1) <= 64." << std::endl;
+			continue;
+		}
+
 		std::cout << "Please enter the desired depth: ";
 		std::cin >> depth;
 
-		std::cout << "The following options are available.\n[1] Player vs Player\n[2] Player vs AI\n[3] AI vs AI\nPlease enter the desired gamemode (0 to quit): ";
+		std::cout << "Please enter the number of search threads: ";
+		std::cin >> threads;
+
+		std::cout << "The following options are available.\n[1] Player vs Player\n[2] Player vs AI\n[3] AI vs AI\n[4] Player vs Solver\n[5] AI vs Solver\n[6] Player vs MCTS\n[7] AI vs MCTS\nPlease enter the desired gamemode (0 to quit): ";
 		std::cin >> choice;
 
 		Connect4* game = new Connect4(rows, cols);
+		GameRecordWriter* records = (!recordFile.empty() && recordWriter.open(recordFile, rows, cols)) ? &recordWriter : nullptr;
 		MiniMax* agent = nullptr;
 		MiniMax* agent2 = nullptr;
+		Solver* solver = nullptr;
+		MCTS* mcts = nullptr;
+		TDLAgent* valueAgents[2] = { nullptr, nullptr };
 		switch (choice) {
 		case 1:
 			beginPvP(game);
@@ -47,30 +164,107 @@ int main()
 		case 2:
 			std::cout << "Do you want to go first (1) or second (2)?: ";
 			std::cin >> playerTurn;
+			std::cout << "Enter the maximum time per AI move in ms (0 for no limit): ";
+			std::cin >> moveTime;
 			agent = (playerTurn == 1) ? new MiniMax(game, depth, PLAYER2) : new MiniMax(game, depth, PLAYER1);
-			beginPvA(game, agent, playerTurn);
+			agent->setMoveTime(moveTime);
+			agent->setThreads(threads);
+			agent->setOpeningBook(&book);
+			agent->setTablebase(&tablebase);
+			beginPvA(game, agent, playerTurn, statsLog, records);
 			delete game;
 			delete agent;
 			break;
 		case 3:
 			agent = new MiniMax(game, depth, PLAYER1);
 			agent2 = new MiniMax(game, depth, PLAYER2);
-			beginAvA(game, agent, agent2);
+			agent->setThreads(threads);
+			agent2->setThreads(threads);
+			agent->setOpeningBook(&book);
+			agent->setTablebase(&tablebase);
+			agent2->setOpeningBook(&book);
+			agent2->setTablebase(&tablebase);
+			beginAvA(game, agent, agent2, statsLog, records);
 			delete game;
 			delete agent;
 			delete agent2;
 			break;
+		case 4:
+			std::cout << "Do you want to go first (1) or second (2)?: ";
+			std::cin >> playerTurn;
+			solver = new Solver(game);
+			solver->setOpeningBook(&book);
+			beginPvA(game, solver, playerTurn, statsLog, records);
+			delete game;
+			delete solver;
+			break;
+		case 5:
+			agent = new MiniMax(game, depth, PLAYER1);
+			agent->setThreads(threads);
+			solver = new Solver(game);
+			agent->setOpeningBook(&book);
+			agent->setTablebase(&tablebase);
+			solver->setOpeningBook(&book);
+			beginAvA(game, agent, solver, statsLog, records);
+			delete game;
+			delete agent;
+			delete solver;
+			break;
+		case 6:
+			std::cout << "Do you want to go first (1) or second (2)?: ";
+			std::cin >> playerTurn;
+			mcts = createMCTS(game, (playerTurn == 1) ? PLAYER2 : PLAYER1, threads, valueAgents, &tablebase);
+			beginPvA(game, mcts, playerTurn, statsLog, records);
+			delete game;
+			delete mcts;
+			break;
+		case 7:
+			agent = new MiniMax(game, depth, PLAYER1);
+			agent->setThreads(threads);
+			agent->setOpeningBook(&book);
+			agent->setTablebase(&tablebase);
+			mcts = createMCTS(game, PLAYER2, threads, valueAgents, &tablebase);
+			beginAvA(game, agent, mcts, statsLog, records);
+			delete game;
+			delete agent;
+			delete mcts;
+			break;
 		default:
 			exit(1);
 		}
+		recordWriter.close();
+		delete valueAgents[0];
+		delete valueAgents[1];
 
 		std::cout << "Would you like to play again? (y/n): ";
 		std::cin >> endGame;
 
 		if (endGame != 'y') break;
 	}
-	// TODO: Add to menu
-	//trainTDL();
+}
+
+// Asks for the MCTS budget and whether to evaluate leaves with the trained TDL tables
+MCTS* createMCTS(Connect4* game, Actor player, int threads, TDLAgent* valueAgents[2], Tablebase* tablebase) {
+	int moveTime = 0;
+	char useValues = 'n';
+	std::cout << "Enter the maximum time per MCTS move in ms (0 for a fixed number of iterations): ";
+	std::cin >> moveTime;
+	std::cout << "Evaluate leaves with the TDL weights instead of random playouts? (y/n): ";
+	std::cin >> useValues;
+
+	MCTS* mcts = new MCTS(game, player);
+	mcts->setMoveTime(moveTime);
+	mcts->setThreads(threads);
+	if (useValues == 'y') {
+		valueAgents[0] = new TDLAgent(false, PLAYER1, 0, 0);
+		valueAgents[1] = new TDLAgent(false, PLAYER2, 0, 0);
+		valueAgents[0]->loadAgent("weights1.bin");
+		valueAgents[1]->loadAgent("weights2.bin");
+		valueAgents[0]->setTablebase(tablebase);
+		valueAgents[1]->setTablebase(tablebase);
+		mcts->setValueAgents(valueAgents[0], valueAgents[1]);
+	}
+	return mcts;
 }
 
 void beginPvP(Connect4* game) {
@@ -98,9 +292,11 @@ void beginPvP(Connect4* game) {
 	std::cout << "And the winner is... " << actors[winner] << "!" << std::endl;
 }
 
-void beginPvA(Connect4* game, MiniMax* agent, int playerTurn) {
+void beginPvA(Connect4* game, Agent* agent, int playerTurn, std::ostream* statsLog, GameRecordWriter* records) {
 	std::string actors[] = { "NONE", "PLAYER 1", "PLAYER 2" };
 	int choice = 0;
+	uint8_t moves[GAME_RECORD_MAX_MOVES];
+	int moveCount = 0;
 
 	// Main game loop
 	game->printBoard();
@@ -108,62 +304,92 @@ void beginPvA(Connect4* game, MiniMax* agent, int playerTurn) {
 		game->setCurrentTurn((game->getCurrentTurn() == PLAYER1) ? PLAYER2 : PLAYER1);
 		std::cout << "It is now " << actors[game->getCurrentTurn()] << " turn.";
 		if (game->getCurrentTurn() == playerTurn) {
+			// The agent keeps searching while the player thinks
+			agent->startPondering();
 			std::cout << "Please select a column: ";
 			std::cin >> choice;
 			while (game->isDominateMove(choice)) {
 				std::cout << "ERROR: Please pick a non-dominate move for the first round: ";
 				std::cin >> choice;
 			}
+			agent->stopPondering();
 		}
 		else {
 			std::cout << " Determining best move..." << std::endl;
 			choice = agent->getAgentMove();
+			logSearchStats(statsLog, game, agent);
 		}
 		int row = game->nextRow(choice);
 		game->addDisc(row, choice);
+		if (row != -1) moves[moveCount++] = choice;
 		game->printBoard();
 		if (game->getCurrentTurn() == PLAYER2)
 			game->incrementRound();
 	}
 	Actor winner = (game->hasWinner()) ? game->getCurrentTurn() : NONE;
 	game->setWinner(winner);
+	if (records != nullptr) records->write(moves, moveCount, winner);
 	std::cout << "And the winner is... " << actors[winner] << "!" << std::endl;
 }
 
-void beginAvA(Connect4* game, MiniMax* agent1, MiniMax* agent2) {
+void beginAvA(Connect4* game, Agent* agent1, Agent* agent2, std::ostream* statsLog, GameRecordWriter* records) {
 	std::string actors[] = { "NONE", "PLAYER 1", "PLAYER 2" };
 	int choice = 0;
+	uint8_t moves[GAME_RECORD_MAX_MOVES];
+	int moveCount = 0;
 
 	// Main game loop
 	game->printBoard();
 	while (!game->hasWinner() && !game->isDraw()) {
 		game->setCurrentTurn((game->getCurrentTurn() == PLAYER1) ? PLAYER2 : PLAYER1);
 		std::cout << "It is now " << actors[game->getCurrentTurn()] << " turn." << std::endl;
-		if (game->getCurrentTurn() == PLAYER1) {
-			choice = agent1->getAgentMove();
-		}
-		else {
-			choice = agent2->getAgentMove();
-		}
+		Agent* agent = (game->getCurrentTurn() == PLAYER1) ? agent1 : agent2;
+		choice = agent->getAgentMove();
+		logSearchStats(statsLog, game, agent);
 		int row = game->nextRow(choice);
 		game->addDisc(row, choice);
+		if (row != -1) moves[moveCount++] = choice;
 		game->printBoard();
 		if (game->getCurrentTurn() == PLAYER2)
 			game->incrementRound();
 	}
 	Actor winner = (game->hasWinner()) ? game->getCurrentTurn() : NONE;
 	game->setWinner(winner);
+	if (records != nullptr) records->write(moves, moveCount, winner);
 	std::cout << "And the winner is... " << actors[winner] << "!" << std::endl;
 }
 
-int beginTvT(Connect4* game, TDLAgent* agent1, TDLAgent* agent2) {
+void logSearchStats(std::ostream* statsLog, Connect4* game, Agent* agent) {
+	SearchStats stats;
+	if (statsLog == nullptr || !agent->getSearchStats(stats)) return;
+
+	*statsLog << "{\"player\":" << game->getCurrentTurn()
+		<< ",\"ply\":" << game->getRows() * game->getCols() - game->getAvailableSpaces()
+		<< ",\"move\":" << stats.move
+		<< ",\"book\":" << (stats.bookMove ? "true" : "false")
+		<< ",\"depth\":" << stats.depthReached
+		<< ",\"score\":" << stats.score
+		<< ",\"nodes\":" << stats.nodes
+		<< ",\"helper_nodes\":" << stats.helperNodes
+		<< ",\"leaf_evaluations\":" << stats.leafEvaluations
+		<< ",\"beta_cutoffs\":" << stats.betaCutoffs
+		<< ",\"tablebase_hits\":" << stats.tablebaseHits
+		<< ",\"first_move_cutoff_rate\":" << stats.firstMoveCutoffRate
+		<< ",\"branching_factor\":" << stats.branchingFactor
+		<< ",\"elapsed_ms\":" << stats.elapsedMs
+		<< "}" << std::endl;
+}
+
+int beginTvT(Connect4* game, TDLAgent* agent1, TDLAgent* agent2, GameRecordWriter* records) {
 	Actor curPlayer = PLAYER1;
 	int winner = 0;
 	bool gameOver = false;
+	uint8_t moves[GAME_RECORD_MAX_MOVES];
+	int moveCount = 0;
 	
 	while (true) {
 		if (!gameOver) {
-			int x = (curPlayer == PLAYER1) ? agent1->getBestMove(game->getBoard()) : agent2->getBestMove(game->getBoard());
+			int x = (curPlayer == PLAYER1) ? agent1->getBestMove(game) : agent2->getBestMove(game);
 			int colHeight = game->nextRow(x);
 			if (!gameOver && colHeight != -1) {
 				if (game->canWin(curPlayer, x, colHeight)) {
@@ -172,6 +398,7 @@ int beginTvT(Connect4* game, TDLAgent* agent1, TDLAgent* agent2) {
 				}
 				game->addDisc(colHeight, x, curPlayer);
 				game->setLastMove({colHeight, x});
+				moves[moveCount++] = x;
 				curPlayer = (curPlayer == PLAYER1) ? PLAYER2 : PLAYER1;
 				if (game->isDraw() && !gameOver) {
 					int col = game->getLastMove().second;
@@ -182,6 +409,7 @@ int beginTvT(Connect4* game, TDLAgent* agent1, TDLAgent* agent2) {
 			}
 		}
 		else {
+			if (records != nullptr) records->write(moves, moveCount, (Actor)winner);
 			if (!agent1->isTraining()) game->printBoard();
 			return winner;
 		}
@@ -195,7 +423,7 @@ int beginMvT(Connect4* game, TDLAgent* agent1, Agent* ref) {
 
 	while (true) {
 		if (!gameOver) {
-			int x = (curPlayer == PLAYER1) ? agent1->getBestMove(game->getBoard()) : ref->getAgentMove();
+			int x = (curPlayer == PLAYER1) ? agent1->getBestMove(game) : ref->getAgentMove();
 			int colHeight = game->nextRow(x);
 			if (!gameOver && colHeight != -1) {
 				if (game->canWin(curPlayer, x, colHeight)) {
@@ -221,7 +449,7 @@ int beginMvT(Connect4* game, TDLAgent* agent1, Agent* ref) {
 	}
 }
 
-void trainTDL() {
+void trainTDL(int threads, double lambda, GameRecordWriter* records, Tablebase* tablebase) {
 	// Initial alpha and epsilon
 	double initialAlpha = 0.004;
 	double initialEpsilon = 0.1;
@@ -243,39 +471,39 @@ void trainTDL() {
 	// Assign agents as their others
 	agent1->setOther(agent2);
 	agent2->setOther(agent1);
+	agent1->setTablebase(tablebase);
+	agent2->setTablebase(tablebase);
 
 	// Initialize game
-	std::cout <<  "Started training!" << std::endl;
+	std::cout <<  "Started training on " << threads << " thread(s) with lambda " << lambda << "!" << std::endl;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 	agent1->toggleTraining();
 
 	// Load agent LUT
-	agent1->loadAgent("weights1.txt");
-	agent2->loadAgent("weights2.txt");
+	agent1->loadAgent("weights1.bin");
+	agent2->loadAgent("weights2.bin");
 	while (true) {
 		trainingState = "TRAIN";
-		trainingGames += 1;
 		int evalInterval = 20000;
-		while (trainingGames % evalInterval != 0) {
-			if (trainingGames % 1000 == 0)
-				std::cout << "Game #" << trainingGames << std::endl;
-
-			// Reset and begin new game
-			delete game;
-			game = new Connect4();
-
-			// Get new winner
-			winner = beginTvT(game, agent1, agent2);
-
-			agent1->computeAlpha();
-			agent2->computeAlpha();
-			trainingGames += 1;
-		}
+		int target = (trainingGames / evalInterval + 1) * evalInterval;
+
+		// Every worker plays its own games into the shared tables until the interval is done
+		std::atomic<int> gameCounter(trainingGames);
+		std::vector<std::thread> workers;
+		for (int i = 0; i < threads; i++)
+			workers.push_back(std::thread(trainWorker, agent1, agent2, initialAlpha, initialEpsilon, lambda, &gameCounter, target, rand(), records, tablebase));
+		for (std::thread& worker : workers)
+			worker.join();
+		trainingGames = target;
+		agent1->computeAlpha(trainingGames);
+		agent2->computeAlpha(trainingGames);
 
 		if (trainingGames % 1000000 == 0) {
-			agent1->saveAgent("weights1.txt");
+			agent1->saveAgent("weights1.bin");
 		}
 
-		std::cout << "Evaluating after game " << trainingGames << std::endl;
+		double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::cout << "Evaluating after game " << trainingGames << " (" << elapsed << " s)" << std::endl;
 		game->printBoard();
 		std::cout << "Current alpha " << agent1->getAlpha() << std::endl;
 		std::cout << "Current epsilon " << agent1->getEpsilon() << std::endl;
@@ -315,14 +543,14 @@ void trainTDL() {
 		// write the output of each evaluation to a file
 		std::ofstream out;
 		out.open(FILENAME, std::ios_base::app);
-		out << trainingGames << "," << score << '\n';
+		out << trainingGames << "," << score << "," << elapsed << '\n';
 		out.close();
 
 		int targetScore = 80;
 		if (score >= targetScore && score <= prevScore1 && score <= prevScore2) {
-			std::cout << "Finished training!" << std::endl;
-			agent1->saveAgent("weights1.txt");
-			agent2->saveAgent("weights2.txt");
+			std::cout << "Finished training after " << trainingGames << " games in " << elapsed << " s!" << std::endl;
+			agent1->saveAgent("weights1.bin");
+			agent2->saveAgent("weights2.bin");
 
 			// Delete game and agents
 			delete game;
@@ -333,4 +561,62 @@ void trainTDL() {
 		prevScore1 = prevScore2;
 		prevScore2 = score;
 	}
-}
\ No newline at end of file
+}
+
+void trainWorker(TDLAgent* shared1, TDLAgent* shared2, double initialAlpha, double initialEpsilon, double lambda,
+	std::atomic<int>* trainingGames, int target, unsigned int seed, GameRecordWriter* records, Tablebase* tablebase) {
+	// Own agents and board, sharing the weight tables of the main agents
+	TDLAgent agent1(true, 1, initialAlpha, initialEpsilon);
+	TDLAgent agent2(false, 2, initialAlpha, initialEpsilon);
+	agent1.shareWeights(shared1);
+	agent2.shareWeights(shared2);
+	agent1.setTablebase(tablebase);
+	agent2.setTablebase(tablebase);
+	agent1.setOther(&agent2);
+	agent2.setOther(&agent1);
+	agent1.setSeed(seed);
+	agent2.setSeed(seed + 1);
+	agent1.setLambda(lambda);
+
+	while (true) {
+		int gamesPlayed = trainingGames->fetch_add(1) + 1;
+		if (gamesPlayed > target) break;
+		if (gamesPlayed % 1000 == 0)
+			std::cout << "Game #" + std::to_string(gamesPlayed) + "\n";
+
+		// The global game count drives the step sizes of every worker
+		agent1.computeAlpha(gamesPlayed);
+		agent2.computeAlpha(gamesPlayed);
+
+		Connect4 game;
+		agent1.resetTraces();
+		beginTvT(&game, &agent1, &agent2, records);
+	}
+}
+
+int summarizeGames(const std::string& fileName) {
+	GameRecordReader reader;
+	if (!reader.open(fileName)) {
+		std::cout << "Unable to read games from " << fileName << std::endl;
+		return 1;
+	}
+
+	long long games = 0;
+	long long moves = 0;
+	long long results[3] = { 0, 0, 0 };
+	GameRecord record;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	while (reader.next(record)) {
+		games++;
+		moves += record.count;
+		results[record.winner]++;
+	}
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << games << " games on a " << reader.getRows() << "x" << reader.getCols() << " board" << std::endl;
+	std::cout << "Player 1 wins: " << results[PLAYER1] << ", Player 2 wins: " << results[PLAYER2]
+		<< ", Draws: " << results[NONE] << std::endl;
+	std::cout << "Average length: " << ((games > 0) ? (double)moves / games : 0) << " moves" << std::endl;
+	std::cout << "Read in " << elapsed * 1000 << " ms (" << ((elapsed > 0) ? games / elapsed : 0) << " games/s)" << std::endl;
+	return 0;
+}
@@ -5,6 +5,43 @@
 //
 #include "connect-four.h"
 
+// A window's state is PLAYER1's disc count + 5 * PLAYER2's disc count
+constexpr int WINDOW_STATES = 25;
+constexpr int WINDOW_STEP[3] = { 0, 1, 5 };
+
+// Score of a window for a player holding `own` discs of it while the opponent holds `other`
+static int windowValue(int own, int other) {
+	if (other > 0) return 0;
+	if (own == 3) return 1000;
+	if (own == 2) return 100;
+	return 0;
+}
+
+// Change to each player's score and four count when `actor` adds a disc to a window in a given state
+struct WindowDelta {
+	int score[3];
+	int fours;
+};
+
+static struct WindowDeltaTable {
+	WindowDelta delta[3][WINDOW_STATES];
+
+	WindowDeltaTable() {
+		for (int actor = PLAYER1; actor <= PLAYER2; actor++) {
+			for (int state = 0; state < WINDOW_STATES; state++) {
+				int before[3] = { 0, state % 5, state / 5 };
+				int after[3] = { 0, before[1], before[2] };
+				after[actor]++;
+				WindowDelta& d = delta[actor][state];
+				d.score[NONE] = 0;
+				d.score[PLAYER1] = windowValue(after[1], after[2]) - windowValue(before[1], before[2]);
+				d.score[PLAYER2] = windowValue(after[2], after[1]) - windowValue(before[2], before[1]);
+				d.fours = (after[actor] == 4) - (before[actor] == 4);
+			}
+		}
+	}
+} windowDeltas;
+
 Connect4::Connect4() { 
 	rows = 6;
 	cols = 7;
@@ -19,46 +56,103 @@ Connect4::Connect4(int rows, int cols) {
 	initBoard();
 }
 
-Connect4::~Connect4() {
-	for (int i = 0; i < rows; i++)
-		delete[] board[i];
-	delete[] board;
+bool Connect4::fitsBitboard(int rows, int cols) { return rows > 0 && cols > 0 && cols * (rows + 1) <= 64; }
+
+int Connect4::countBits(uint64_t bits) {
+	bits = bits - ((bits >> 1) & 0x5555555555555555ULL);
+	bits = (bits & 0x3333333333333333ULL) + ((bits >> 2) & 0x3333333333333333ULL);
+	bits = (bits + (bits >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return (int)((bits * 0x0101010101010101ULL) >> 56);
 }
 
 void Connect4::initBoard() {
-	// Initialize rows
-	try
-	{
-		board = new int* [rows];
-	}
-	catch (std::bad_alloc)
-	{
-		std::cerr << "Could not allocate sufficient space" << std::endl;
+	if (!fitsBitboard(rows, cols)) {
+		std::cerr << "Board is too large: cols * (rows + 1) must be at most 64" << std::endl;
 		std::exit(1);
 	}
 
-	// Initialize cols
-	for (int i = 0; i < rows; i++)
-		board[i] = new int[cols];
-
 	// Mark the entire board as empty
-	for (int i = 0; i < rows; i++)
-		for (int j = 0; j < cols; j++)
-			board[i][j] = 0;
+	position[PLAYER1] = 0;
+	position[PLAYER2] = 0;
+	mask = 0;
+	for (int i = 0; i < cols; i++)
+		heights[i] = 0;
+
+	// Dispatch to the compile-time geometry where there is one for this size
+	size = (rows == 6 && cols == 7) ? SIZE_6X7 : SIZE_CUSTOM;
+
+	// Every playable cell, leaving out the empty bit on top of each column
+	if (size == SIZE_6X7) boardMask = BoardShape<6, 7>::boardMask();
+	else {
+		uint64_t column = ((uint64_t)1 << rows) - 1;
+		boardMask = 0;
+		for (int i = 0; i < cols; i++)
+			boardMask |= column << (i * (rows + 1));
+	}
+
+	initWindows();
 }
 
-void Connect4::addDisc(int row, int col) {
-	// Check if invalid move
-	if (!validMove(0, col) || row == -1) {
-		std::cout << "Attempted Move: " << row << ", " << col << std::endl;
-		std::cout << "Invalid move on board...skipping turn" << std::endl;
-		return;
+void Connect4::initWindows() {
+	// Collect every line of four cells as bit indices
+	std::vector<std::vector<int>> windowsOfCell(cols * (rows + 1));
+	int numWindows = 0;
+	int directions[4][2] = { { 0, 1 }, { 1, 0 }, { 1, 1 }, { 1, -1 } };
+	for (int col = 0; col < cols; col++) {
+		for (int height = 0; height < rows; height++) {
+			for (int* d : directions) {
+				int endCol = col + 3 * d[0];
+				int endHeight = height + 3 * d[1];
+				if (endCol >= cols || endHeight < 0 || endHeight >= rows) continue;
+				for (int k = 0; k < 4; k++)
+					windowsOfCell[(col + k * d[0]) * (rows + 1) + height + k * d[1]].push_back(numWindows);
+				numWindows++;
+			}
+		}
+	}
+
+	// Flatten into one list per cell
+	cellWindowStart.assign(1, 0);
+	cellWindows.clear();
+	for (std::vector<int>& windows : windowsOfCell) {
+		cellWindows.insert(cellWindows.end(), windows.begin(), windows.end());
+		cellWindowStart.push_back((int)cellWindows.size());
+	}
+
+	windowState.assign(numWindows, 0);
+	for (int i = 0; i < 3; i++) {
+		windowScore[i] = 0;
+		fourCount[i] = 0;
 	}
-	availableSpaces--;
-	board[row][col] = currentTurn;
-	lastMove = { row, col };
 }
 
+void Connect4::updateWindows(int index, Actor actor, int delta) {
+	uint8_t* states = windowState.data();
+	for (int i = cellWindowStart[index]; i < cellWindowStart[index + 1]; i++) {
+		int window = cellWindows[i];
+		if (delta > 0) {
+			const WindowDelta& d = windowDeltas.delta[actor][states[window]];
+			windowScore[PLAYER1] += d.score[PLAYER1];
+			windowScore[PLAYER2] += d.score[PLAYER2];
+			fourCount[actor] += d.fours;
+			states[window] += WINDOW_STEP[actor];
+		}
+		else {
+			states[window] -= WINDOW_STEP[actor];
+			const WindowDelta& d = windowDeltas.delta[actor][states[window]];
+			windowScore[PLAYER1] -= d.score[PLAYER1];
+			windowScore[PLAYER2] -= d.score[PLAYER2];
+			fourCount[actor] -= d.fours;
+		}
+	}
+}
+
+int Connect4::cellIndex(int row, int col) { return col * (rows + 1) + (rows - 1 - row); }
+
+uint64_t Connect4::cellBit(int row, int col) { return (uint64_t)1 << cellIndex(row, col); }
+
+void Connect4::addDisc(int row, int col) { addDisc(row, col, currentTurn); }
+
 void Connect4::addDisc(int row, int col, Actor actor) {
 	// Check if invalid move
 	if (!validMove(0, col) || row == -1) {
@@ -67,13 +161,25 @@ void Connect4::addDisc(int row, int col, Actor actor) {
 		return;
 	}
 	availableSpaces--;
-	board[row][col] = actor;
+	int index = cellIndex(row, col);
+	uint64_t bit = (uint64_t)1 << index;
+	position[actor] |= bit;
+	mask |= bit;
+	heights[col] = rows - row;
+	updateWindows(index, actor, 1);
 	lastMove = { row, col };
 }
 
 void Connect4::removeDisc(int row, int col) {
-	if (validMove(row, col))
-		board[row][col] = 0;
+	if (validMove(row, col)) {
+		int index = cellIndex(row, col);
+		uint64_t bit = (uint64_t)1 << index;
+		if (mask & bit) updateWindows(index, (position[PLAYER1] & bit) ? PLAYER1 : PLAYER2, -1);
+		position[PLAYER1] &= ~bit;
+		position[PLAYER2] &= ~bit;
+		mask &= ~bit;
+		heights[col] = rows - 1 - row;
+	}
 	availableSpaces++;
 }
 
@@ -82,7 +188,7 @@ void Connect4::printBoard() {
 	for (int i = 0; i < rows; i++) {
 		result += "|";
 		for (int j = 0; j < cols; j++)
-			result += (!board[i][j]) ? "   |" : " " + std::to_string(board[i][j]) + " |";
+			result += (!getCell(i, j)) ? "   |" : " " + std::to_string(getCell(i, j)) + " |";
 		result += "\n+" + repeat("---+", cols) + '\n';
 	}
 	for (int i = 0; i < cols; i++) {
@@ -93,11 +199,8 @@ void Connect4::printBoard() {
 }
 
 int Connect4::nextRow(int col) {
-	int n = -1;
-	for (int i = 0; i < rows; i++)
-		if (!board[i][col])
-			n = i;
-	return n;
+	if (col < 0 || col >= cols || heights[col] == rows) return -1;
+	return rows - 1 - heights[col];
 }
 
 bool Connect4::validMove(int row, int col) { return (col >= 0) && (col < cols) && (row >= 0) && (row < rows); }
@@ -105,67 +208,25 @@ bool Connect4::validMove(int row, int col) { return (col >= 0) && (col < cols) &
 bool Connect4::isDominateMove(int col) { return round == 1 && (col == 0 || (cols % 2 == 1 && col == cols / 2) || col == cols - 1); }
 
 bool Connect4::hasWinner() {
-	int n = 0;
-	int row = lastMove.first;
-	int col = lastMove.second;
-	int player = (availableSpaces % 2 == 0) ? PLAYER2 : PLAYER1;
+	// Only the player who made the last move can have just won (PLAYER1 always moves first)
+	int movesPlayed = rows * cols - availableSpaces;
+	Actor player = (movesPlayed % 2 == 0) ? PLAYER2 : PLAYER1;
+	return alignment(position[player]);
+}
 
-	// Check horizontally
-	for (int i = col - 3; i <= col; i++) {
-		if (i >= 0 && i + 3 < cols) {
-			bool win = true;
-			for (int j = 0; j < 4; j++) {
-				if (board[row][i + j] != player) {
-					win = false;
-					break;
-				}
-			}
-			if (win) return true;
-		}
-	}
+bool Connect4::alignment(uint64_t pos) {
+	if (size == SIZE_6X7) return BoardShape<6, 7>::alignment(pos);
 
-	// Check vertically
-	for (int i = row - 3; i <= row; i++) {
-		if (i >= 0 && i + 3 < rows) {
-			bool win = true;
-			for (int j = 0; j < 4; j++) {
-				if (board[i + j][col] != player) {
-					win = false;
-					break;
-				}
-			}
-			if (win) return true;
-		}
-	}
+	int h = rows + 1;
 
-	// Check diagonally (top left to bottom right)
-	for (int i = -3; i <= 0; i++) {
-		if (row + i >= 0 && row + i + 3 < rows && col + i >= 0 && col + i + 3 < cols) {
-			bool win = true;
-			for (int j = 0; j < 4; j++) {
-				if (board[row + i + j][col + i + j] != player) {
-					win = false;
-					break;
-				}
-			}
-			if (win) return true;
-		}
-	}
-
-	// Check diagonally (right to left)
-	for (int i = -3; i <= 0; i++) {
-		if (row + i >= 0 && row + i + 3 < rows && col - i >= 0 && col - i - 3 < cols) {
-			bool win = true;
-			for (int j = 0; j < 4; j++) {
-				if (board[row + i + j][col - i - j] != player) {
-					win = false;
-					break;
-				}
-			}
-			if (win) return true;
-		}
+	// Horizontal, both diagonals and vertical
+	int shifts[4] = { h, h - 1, h + 1, 1 };
+	for (int shift : shifts) {
+		if (3 * shift >= 64) continue; // No four in a row fits in this direction
+		uint64_t m = pos & (pos >> shift);
+		if (m & (m >> (2 * shift)))
+			return true;
 	}
-
 	return false;
 }
 
@@ -188,1031 +249,112 @@ void Connect4::setCurrentTurn(Actor a) { currentTurn = a; }
 
 int Connect4::getAvailableSpaces() { return availableSpaces; }
 
-int Connect4::getCell(int x, int y) { return board[x][y]; }
+int Connect4::getCell(int x, int y) {
+	uint64_t bit = cellBit(x, y);
+	if (position[PLAYER1] & bit) return PLAYER1;
+	if (position[PLAYER2] & bit) return PLAYER2;
+	return NONE;
+}
 
 int Connect4::getRows() { return rows; }
 
 int Connect4::getCols() { return cols; }
 
-void Connect4::setBoard(int** board) {
-	resetBoard();
-	for (int j = 0; j < rows; j++) {
-		for (int i = 0; i < cols; i++) {
-			this->board[j][i] = board[j][i];
-		}
-	}
-
-	// Update availableSpaces based on the last filled row in each column
-	for (int i = 0; i < cols; i++) {
-		availableSpaces -= rows - (nextRow(i) + 1);
-	}
-}
+uint64_t Connect4::getPosition(Actor a) { return position[a]; }
 
-int** Connect4::getBoard() { return board; }
+uint64_t Connect4::getMask() { return mask; }
 
-void Connect4::resetBoard() {
-	for (int i = 0; i < rows; i++)
-		delete[] board[i];
-	delete[] board;
-	initBoard();
-	availableSpaces = 42;
-}
+uint64_t Connect4::getBoardMask() { return boardMask; }
 
-int** Connect4::getMirroredField(int** board) {
-    int** mirroredField = new int*[rows];
-    for (int i = 0; i < rows; ++i) {
-        mirroredField[i] = new int[cols];
-        for (int j = 0; j < cols; ++j) {
-            mirroredField[i][j] = board[rows - i - 1][j];
-        }
-    }
-    return mirroredField;
-}
+int Connect4::getWindowScore(Actor a) { return windowScore[a]; }
 
-bool Connect4::isDraw() { 
-	return availableSpaces <= 0; 
-}
+int Connect4::getFourCount(Actor a) { return fourCount[a]; }
 
-bool Connect4::canWin(int player, int col, int row) {
-	switch (row * 7 + col) {
-	case 35:
-		if (isMatchingBoard(player, { 29, 23, 17 }) || isMatchingBoard(player, { 36, 37, 38 }))
-			return true;
-		break;
-	case 28:
-		if (isMatchingBoard(player, { 29, 30, 31 }) || isMatchingBoard(player, { 22, 16, 10 }))
-			return true;
-		break;
-	case 21:
-		if (isMatchingBoard(player, { 22, 23, 24 }) || isMatchingBoard(player, { 15, 9, 3 }))
-			return true;
-		break;
-	case 14:
-		if (isMatchingBoard(player, { 35, 28, 21 }) || isMatchingBoard(player, { 22, 30, 38 }) || isMatchingBoard(player, { 15, 16, 17 }))
-			return true;
-		break;
-	case 7:
-		if (isMatchingBoard(player, { 15, 23, 31 }) || isMatchingBoard(player, { 28, 21, 14 }) || isMatchingBoard(player, { 8, 9, 10 }))
-			return true;
-		break;
-	case 0:
-		if (isMatchingBoard(player, { 8, 16, 24 }) || isMatchingBoard(player, { 21, 14, 7 }) || isMatchingBoard(player, { 1, 2, 3 }))
-			return true;
-		break;
-	case 36:
-		if (isMatchingBoard(player, { 30, 24, 18 }) || isMatchingBoard(player, { 37, 38, 39 }) || isMatchingBoard(player, { 35, 37, 38 }))
-			return true;
-		break;
-	case 29:
-		if (isMatchingBoard(player, { 28, 30, 31 }) || isMatchingBoard(player, { 35, 23, 17 })
-			|| isMatchingBoard(player, { 30, 31, 32 }) || isMatchingBoard(player, { 23, 17, 11 }))
-			return true;
-		break;
-	case 22:
-		if (isMatchingBoard(player, { 21, 23, 24 }) || isMatchingBoard(player, { 14, 30, 38 })
-			|| isMatchingBoard(player, { 23, 24, 25 }) || isMatchingBoard(player, { 28, 16, 10 }) || isMatchingBoard(player, { 16, 10, 4 }))
-			return true;
-		break;
-	case 15:
-		if (isMatchingBoard(player, { 23, 31, 39 }) || isMatchingBoard(player, { 36, 29, 22 })
-			|| isMatchingBoard(player, { 16, 17, 18 }) || isMatchingBoard(player, { 14, 16, 17 })
-			|| isMatchingBoard(player, { 21, 9, 3 }) || isMatchingBoard(player, { 7, 23, 31 }))
-			return true;
-		break;
-	case 8:
-		if (isMatchingBoard(player, { 16, 24, 32 }) || isMatchingBoard(player, { 9, 10, 11 })
-			|| isMatchingBoard(player, { 29, 22, 15 }) || isMatchingBoard(player, { 7, 9, 10 }) || isMatchingBoard(player, { 0, 16, 24 }))
-			return true;
-		break;
-	case 1:
-		if (isMatchingBoard(player, { 9, 17, 25 }) || isMatchingBoard(player, { 2, 3, 4 })
-			|| isMatchingBoard(player, { 22, 15, 8 }) || isMatchingBoard(player, { 0, 2, 3 }))
-			return true;
-		break;
-	case 37:
-		if (isMatchingBoard(player, { 31, 25, 19 }) || isMatchingBoard(player, { 35, 36, 38 })
-			|| isMatchingBoard(player, { 38, 39, 40 }) || isMatchingBoard(player, { 36, 38, 39 }))
-			return true;
-		break;
-	case 30:
-		if (isMatchingBoard(player, { 14, 22, 38 }) || isMatchingBoard(player, { 28, 29, 31 })
-			|| isMatchingBoard(player, { 36, 24, 18 }) || isMatchingBoard(player, { 31, 32, 33 })
-			|| isMatchingBoard(player, { 29, 31, 32 }) || isMatchingBoard(player, { 24, 18, 12 }))
-			return true;
-		break;
-	case 23:
-		if (isMatchingBoard(player, { 15, 31, 39 }) || isMatchingBoard(player, { 21, 22, 24 })
-			|| isMatchingBoard(player, { 35, 29, 17 }) || isMatchingBoard(player, { 22, 24, 25 })
-			|| isMatchingBoard(player, { 24, 25, 26 }) || isMatchingBoard(player, { 29, 17, 11 })
-			|| isMatchingBoard(player, { 7, 15, 31 }) || isMatchingBoard(player, { 17, 11, 5 }))
-			return true;
-		break;
-	case 16:
-		if (isMatchingBoard(player, { 24, 32, 40 }) || isMatchingBoard(player, { 28, 22, 10 })
-			|| isMatchingBoard(player, { 14, 15, 17 }) || isMatchingBoard(player, { 15, 17, 18 })
-			|| isMatchingBoard(player, { 22, 10, 4 }) || isMatchingBoard(player, { 8, 24, 32 })
-			|| isMatchingBoard(player, { 37, 30, 23 }) || isMatchingBoard(player, { 17, 18, 19 }) || isMatchingBoard(player, { 0, 8, 24 }))
-			return true;
-		break;
-	case 9:
-		if (isMatchingBoard(player, { 17, 25, 33 }) || isMatchingBoard(player, { 21, 15, 3 })
-			|| isMatchingBoard(player, { 8, 10, 11 }) || isMatchingBoard(player, { 1, 17, 25 })
-			|| isMatchingBoard(player, { 10, 11, 12 }) || isMatchingBoard(player, { 30, 23, 16 }) || isMatchingBoard(player, { 7, 8, 10 }))
-			return true;
-		break;
-	case 2:
-		if (isMatchingBoard(player, { 10, 18, 26 }) || isMatchingBoard(player, { 23, 16, 9 })
-			|| isMatchingBoard(player, { 1, 3, 4 }) || isMatchingBoard(player, { 3, 4, 5 }) || isMatchingBoard(player, { 0, 1, 3 }))
-			return true;
-		break;
-	case 38:
-		if (isMatchingBoard(player, { 35, 36, 37 }) || isMatchingBoard(player, { 36, 37, 39 })
-			|| isMatchingBoard(player, { 37, 39, 40 }) || isMatchingBoard(player, { 39, 40, 41 })
-			|| isMatchingBoard(player, { 32, 26, 20 }) || isMatchingBoard(player, { 14, 22, 30 }))
-			return true;
-		break;
-	case 31:
-		if (isMatchingBoard(player, { 37, 25, 19 }) || isMatchingBoard(player, { 32, 33, 34 })
-			|| isMatchingBoard(player, { 28, 29, 30 }) || isMatchingBoard(player, { 7, 15, 23 })
-			|| isMatchingBoard(player, { 15, 23, 39 }) || isMatchingBoard(player, { 30, 32, 33 })
-			|| isMatchingBoard(player, { 25, 19, 13 }) || isMatchingBoard(player, { 29, 30, 32 }))
-			return true;
-		break;
-	case 24:
-		if (isMatchingBoard(player, { 36, 30, 18 }) || isMatchingBoard(player, { 16, 32, 40 })
-			|| isMatchingBoard(player, { 21, 22, 23 }) || isMatchingBoard(player, { 22, 23, 25 })
-			|| isMatchingBoard(player, { 23, 25, 26 }) || isMatchingBoard(player, { 25, 26, 27 })
-			|| isMatchingBoard(player, { 8, 16, 32 }) || isMatchingBoard(player, { 30, 18, 12 })
-			|| isMatchingBoard(player, { 18, 12, 6 }) || isMatchingBoard(player, { 0, 8, 16 }))
-			return true;
-		break;
-	case 17:
-		if (isMatchingBoard(player, { 35, 29, 23 }) || isMatchingBoard(player, { 25, 33, 41 })
-			|| isMatchingBoard(player, { 38, 31, 24 }) || isMatchingBoard(player, { 14, 15, 16 })
-			|| isMatchingBoard(player, { 9, 25, 33 }) || isMatchingBoard(player, { 29, 23, 11 })
-			|| isMatchingBoard(player, { 16, 18, 19 }) || isMatchingBoard(player, { 15, 16, 18 })
-			|| isMatchingBoard(player, { 1, 9, 25 }) || isMatchingBoard(player, { 23, 11, 5 }) || isMatchingBoard(player, { 18, 19, 20 }))
-			return true;
-		break;
-	case 10:
-		if (isMatchingBoard(player, { 28, 22, 16 }) || isMatchingBoard(player, { 31, 24, 17 })
-			|| isMatchingBoard(player, { 18, 26, 34 }) || isMatchingBoard(player, { 22, 16, 4 })
-			|| isMatchingBoard(player, { 7, 8, 9 }) || isMatchingBoard(player, { 2, 18, 26 })
-			|| isMatchingBoard(player, { 8, 9, 11 }) || isMatchingBoard(player, { 9, 11, 12 }) || isMatchingBoard(player, { 11, 12, 13 }))
-			return true;
-		break;
-	case 3:
-		if (isMatchingBoard(player, { 24, 17, 10 }) || isMatchingBoard(player, { 21, 15, 9 })
-			|| isMatchingBoard(player, { 11, 19, 27 }) || isMatchingBoard(player, { 0, 1, 2 })
-			|| isMatchingBoard(player, { 1, 2, 4 }) || isMatchingBoard(player, { 2, 4, 5 }) || isMatchingBoard(player, { 4, 5, 6 }))
-			return true;
-		break;
-	case 39:
-		if (isMatchingBoard(player, { 15, 23, 31 }) || isMatchingBoard(player, { 38, 40, 41 })
-			|| isMatchingBoard(player, { 37, 38, 40 }) || isMatchingBoard(player, { 36, 37, 38 }))
-			return true;
-		break;
-	case 32:
-		if (isMatchingBoard(player, { 38, 26, 20 }) || isMatchingBoard(player, { 16, 24, 40 })
-			|| isMatchingBoard(player, { 31, 33, 34 }) || isMatchingBoard(player, { 30, 31, 33 })
-			|| isMatchingBoard(player, { 29, 30, 31 }) || isMatchingBoard(player, { 8, 16, 24 }))
-			return true;
-		break;
-	case 25:
-		if (isMatchingBoard(player, { 17, 33, 41 }) || isMatchingBoard(player, { 37, 31, 19 })
-			|| isMatchingBoard(player, { 23, 24, 26 }) || isMatchingBoard(player, { 22, 23, 24 })
-			|| isMatchingBoard(player, { 24, 26, 27 }) || isMatchingBoard(player, { 9, 17, 33 })
-			|| isMatchingBoard(player, { 31, 19, 13 }) || isMatchingBoard(player, { 1, 9, 17 }))
-			return true;
-		break;
-	case 18:
-		if (isMatchingBoard(player, { 36, 30, 24 }) || isMatchingBoard(player, { 10, 26, 34 })
-			|| isMatchingBoard(player, { 39, 32, 25 }) || isMatchingBoard(player, { 16, 17, 19 })
-			|| isMatchingBoard(player, { 15, 16, 17 }) || isMatchingBoard(player, { 30, 24, 12 })
-			|| isMatchingBoard(player, { 2, 10, 26 }) || isMatchingBoard(player, { 17, 19, 20 }) || isMatchingBoard(player, { 24, 12, 6 }))
-			return true;
-		break;
-	case 11:
-		if (isMatchingBoard(player, { 29, 23, 17 }) || isMatchingBoard(player, { 3, 19, 27 })
-			|| isMatchingBoard(player, { 32, 25, 18 }) || isMatchingBoard(player, { 9, 10, 12 })
-			|| isMatchingBoard(player, { 8, 9, 10 }) || isMatchingBoard(player, { 23, 17, 5 }) || isMatchingBoard(player, { 10, 12, 13 }))
-			return true;
-		break;
-	case 4:
-		if (isMatchingBoard(player, { 22, 16, 10 }) || isMatchingBoard(player, { 25, 18, 11 })
-			|| isMatchingBoard(player, { 2, 3, 5 }) || isMatchingBoard(player, { 1, 2, 3 }) || isMatchingBoard(player, { 3, 5, 6 }))
-			return true;
-		break;
-	case 40:
-		if (isMatchingBoard(player, { 16, 24, 32 }) || isMatchingBoard(player, { 37, 38, 39 }) || isMatchingBoard(player, { 38, 39, 41 }))
-			return true;
-		break;
-	case 33:
-		if (isMatchingBoard(player, { 30, 31, 32 }) || isMatchingBoard(player, { 31, 32, 34 })
-			|| isMatchingBoard(player, { 17, 25, 41 }) || isMatchingBoard(player, { 9, 17, 25 }))
-			return true;
-		break;
-	case 26:
-		if (isMatchingBoard(player, { 23, 24, 25 }) || isMatchingBoard(player, { 24, 25, 27 })
-			|| isMatchingBoard(player, { 10, 18, 34 }) || isMatchingBoard(player, { 38, 32, 20 }) || isMatchingBoard(player, { 2, 10, 18 }))
-			return true;
-		break;
-	case 19:
-		if (isMatchingBoard(player, { 37, 31, 25 }) || isMatchingBoard(player, { 16, 17, 18 })
-			|| isMatchingBoard(player, { 40, 33, 26 }) || isMatchingBoard(player, { 17, 18, 20 })
-			|| isMatchingBoard(player, { 3, 11, 27 }) || isMatchingBoard(player, { 31, 25, 13 }))
-			return true;
-		break;
-	case 12:
-		if (isMatchingBoard(player, { 30, 24, 18 }) || isMatchingBoard(player, { 9, 10, 11 })
-			|| isMatchingBoard(player, { 33, 26, 19 }) || isMatchingBoard(player, { 10, 11, 13 }) || isMatchingBoard(player, { 24, 18, 6 }))
-			return true;
-		break;
-	case 5:
-		if (isMatchingBoard(player, { 23, 17, 11 }) || isMatchingBoard(player, { 2, 3, 4 })
-			|| isMatchingBoard(player, { 26, 19, 12 }) || isMatchingBoard(player, { 3, 4, 6 }))
-			return true;
-		break;
-	case 41:
-		if (isMatchingBoard(player, { 17, 25, 33 }) || isMatchingBoard(player, { 38, 39, 40 }))
-			return true;
-		break;
-	case 34:
-		if (isMatchingBoard(player, { 31, 32, 33 }) || isMatchingBoard(player, { 10, 18, 26 }))
-			return true;
-		break;
-	case 27:
-		if (isMatchingBoard(player, { 24, 25, 26 }) || isMatchingBoard(player, { 3, 11, 19 }))
-			return true;
-		break;
-	case 20:
-		if (isMatchingBoard(player, { 38, 32, 26 }) || isMatchingBoard(player, { 41, 34, 27 }) || isMatchingBoard(player, { 17, 18, 19 }))
-			return true;
-		break;
-	case 13:
-		if (isMatchingBoard(player, { 31, 25, 19 }) || isMatchingBoard(player, { 34, 27, 20 }) || isMatchingBoard(player, { 10, 11, 12 }))
-			return true;
-		break;
-	case 6:
-		if (isMatchingBoard(player, { 24, 18, 12 }) || isMatchingBoard(player, { 27, 20, 13 }) || isMatchingBoard(player, { 3, 4, 5 }))
-			return true;
-		break;
-	}
-	return false;
+// Number of open windows that a disc at (row, col) would bring to three of the player's discs
+int Connect4::countNewThreats(int row, int col, Actor a) {
+	int index = cellIndex(row, col);
+	int twoOwnNoOther = 2 * WINDOW_STEP[a];
+	int threats = 0;
+	for (int i = cellWindowStart[index]; i < cellWindowStart[index + 1]; i++)
+		threats += (windowState[cellWindows[i]] == twoOwnNoOther);
+	return threats;
 }
 
-std::vector<int> Connect4::generateTDLMoves(int player) {
-	int p = (player == PLAYER1) ? PLAYER2 : PLAYER1;
-	std::vector<int> cn(7);
-	int count;
-	int i;
-	int j = 0;
-	int index = 0;
+// Unique per position: the mask plus one player's discs carries into a single bit above each column
+uint64_t Connect4::getKey() { return position[PLAYER1] + mask; }
 
-	switch (nextRow(0)) {
-	case 5:
-		count = 7;
-		if (!isMatchingBoard(p, { 35, 29, 23, 17 }))
-			count--;
-		if (!isMatchingBoard(p, { 35, 36, 37, 38 }))
-			count--;
-		if (!isMatchingBoard(p, { 35, 28, 21, 14 }))
-			count--;
-		break;
-	case 4:
-		count = 9;
-		if (!isMatchingBoard(p, { 28, 22, 16, 10 }))
-			count--;
-		if (!isMatchingBoard(p, { 28, 29, 30, 31 }))
-			count--;
-		if (!isMatchingBoard(p, { 35, 28, 21, 14 }))
-			count--;
-		if (!isMatchingBoard(p, { 28, 21, 14, 7 }))
-			count--;
-		break;
-	case 3:
-		count = 11;
-		if (!isMatchingBoard(p, { 21, 15, 9, 3 }))
-			count--;
-		if (!isMatchingBoard(p, { 21, 22, 23, 24 }))
-			count--;
-		if (!isMatchingBoard(p, { 35, 28, 21, 14 }))
-			count--;
-		if (!isMatchingBoard(p, { 28, 21, 14, 7 }))
-			count--;
-		if (!isMatchingBoard(p, { 21, 14, 7, 0 }))
-			count--;
-		break;
-	case 2:
-		count = 10;
-		if (!isMatchingBoard(p, { 14, 15, 16, 17 }))
-			count--;
-		if (!isMatchingBoard(p, { 14, 22, 30, 38 }))
-			count--;
-		if (!isMatchingBoard(p, { 35, 28, 21, 14 }))
-			count--;
-		if (!isMatchingBoard(p, { 28, 21, 14, 7 }))
-			count--;
-		if (!isMatchingBoard(p, { 21, 14, 7, 0 }))
-			count--;
-		break;
-	case 1:
-		count = 8;
-		if (!isMatchingBoard(p, { 7, 8, 9, 10 }))
-			count--;
-		if (!isMatchingBoard(p, { 7, 15, 23, 31 }))
-			count--;
-		if (!isMatchingBoard(p, { 28, 21, 14, 7 }))
-			count--;
-		if (!isMatchingBoard(p, { 21, 14, 7, 0 }))
-			count--;
-		break;
-	case 0:
-		count = 6;
-		if (!isMatchingBoard(p, { 0, 1, 2, 3 }))
-			count--;
-		if (!isMatchingBoard(p, { 0, 8, 16, 24 }))
-			count--;
-		if (!isMatchingBoard(p, { 21, 14, 7, 0 }))
-			count--;
-		break;
-	default: count = 0;
-	}
-	cn[0] = count;
-
-	switch (nextRow(1)) {
-	case 5:
-		count = 9;
-		if (!isMatchingBoard(p, { 36, 30, 24, 18 }))
-			count--;
-		if (!isMatchingBoard(p, { 35, 36, 37, 38 }))
-			count--;
-		if (!isMatchingBoard(p, { 36, 37, 38, 39 }))
-			count--;
-		if (!isMatchingBoard(p, { 36, 29, 22, 15 }))
-			count--;
-		break;
-	case 4:
-		count = 13;
-		if (!isMatchingBoard(p, { 29, 23, 17, 11 }))
-			count--;
-		if (!isMatchingBoard(p, { 35, 29, 23, 17 }))
-			count--;
-		if (!isMatchingBoard(p, { 28, 29, 30, 31 }))
-			count--;
-		if (!isMatchingBoard(p, { 29, 30, 31, 32 }))
-			count--;
-		if (!isMatchingBoard(p, { 36, 29, 22, 15 }))
-			count--;
-		if (!isMatchingBoard(p, { 29, 22, 15, 8 }))
-			count--;
-		break;
-	case 3:
-		count = 17;
-		if (!isMatchingBoard(p, { 22, 16, 10, 4 }))
-			count--;
-		if (!isMatchingBoard(p, { 28, 22, 16, 10 }))
-			count--;
-		if (!isMatchingBoard(p, { 21, 22, 23, 24 }))
-			count--;
-		if (!isMatchingBoard(p, { 22, 23, 24, 25 }))
-			count--;
-		if (!isMatchingBoard(p, { 14, 22, 30, 38 }))
-			count--;
-		if (!isMatchingBoard(p, { 36, 29, 22, 15 }))
-			count--;
-		if (!isMatchingBoard(p, { 29, 22, 15, 8 }))
-			count--;
-		if (!isMatchingBoard(p, { 22, 15, 8, 1 }))
-			count--;
-		break;
-	case 2:
-		count = 16;
-		if (!isMatchingBoard(p, { 21, 15, 9, 3 }))
-			count--;
-		if (!isMatchingBoard(p, { 14, 15, 16, 17 }))
-			count--;
-		if (!isMatchingBoard(p, { 15, 16, 17, 18 }))
-			count--;
-		if (!isMatchingBoard(p, { 7, 15, 23, 31 }))
-			count--;
-		if (!isMatchingBoard(p, { 15, 23, 31, 39 }))
-			count--;
-		if (!isMatchingBoard(p, { 36, 29, 22, 15 }))
-			count--;
-		if (!isMatchingBoard(p, { 29, 22, 15, 8 }))
-			count--;
-		if (!isMatchingBoard(p, { 22, 15, 8, 1 }))
-			count--;
-		break;
-	case 1:
-		count = 12;
-		if (!isMatchingBoard(p, { 7, 8, 9, 10 }))
-			count--;
-		if (!isMatchingBoard(p, { 8, 9, 10, 11 }))
-			count--;
-		if (!isMatchingBoard(p, { 0, 8, 16, 24 }))
-			count--;
-		if (!isMatchingBoard(p, { 8, 16, 24, 32 }))
-			count--;
-		if (!isMatchingBoard(p, { 29, 22, 15, 8 }))
-			count--;
-		if (!isMatchingBoard(p, { 22, 15, 8, 1 }))
-			count--;
-		break;
-	case 0:
-		count = 8;
-		if (!isMatchingBoard(p, { 0, 1, 2, 3 }))
-			count--;
-		if (!isMatchingBoard(p, { 1, 2, 3, 4 }))
-			count--;
-		if (!isMatchingBoard(p, { 1, 9, 17, 25 }))
-			count--;
-		if (!isMatchingBoard(p, { 22, 15, 8, 1 }))
-			count--;
-		break;
-	default: count = 0;
-	}
-	cn[1] = count;
-
-	switch (nextRow(2)) {
-	case 5:
-		count = 11;
-		if (!isMatchingBoard(p, { 37, 31, 25, 19 }))
-			count--;
-		if (!isMatchingBoard(p, { 35, 36, 37, 38 }))
-			count--;
-		if (!isMatchingBoard(p, { 36, 37, 38, 39 }))
-			count--;
-		if (!isMatchingBoard(p, { 37, 38, 39, 40 }))
-			count--;
-		if (!isMatchingBoard(p, { 37, 30, 23, 16 }))
-			count--;
-		break;
-	case 4:
-		count = 17;
-		if (!isMatchingBoard(p, { 30, 24, 18, 12 }))
-			count--;
-		if (!isMatchingBoard(p, { 14, 22, 30, 38 }))
-			count--;
-		if (!isMatchingBoard(p, { 36, 30, 24, 18 }))
-			count--;
-		if (!isMatchingBoard(p, { 28, 29, 30, 31 }))
-			count--;
-		if (!isMatchingBoard(p, { 29, 30, 31, 32 }))
-			count--;
-		if (!isMatchingBoard(p, { 30, 31, 32, 33 }))
-			count--;
-		if (!isMatchingBoard(p, { 37, 30, 23, 16 }))
-			count--;
-		if (!isMatchingBoard(p, { 30, 23, 16, 9 }))
-			count--;
-		break;
-	case 3:
-		count = 23;
-		if (!isMatchingBoard(p, { 23, 17, 11, 5 }))
-			count--;
-		if (!isMatchingBoard(p, { 7, 15, 23, 31 }))
-			count--;
-		if (!isMatchingBoard(p, { 29, 23, 17, 11 }))
-			count--;
-		if (!isMatchingBoard(p, { 21, 22, 23, 24 }))
-			count--;
-		if (!isMatchingBoard(p, { 22, 23, 24, 25 }))
-			count--;
-		if (!isMatchingBoard(p, { 23, 24, 25, 26 }))
-			count--;
-		if (!isMatchingBoard(p, { 15, 23, 31, 39 }))
-			count--;
-		if (!isMatchingBoard(p, { 35, 29, 23, 17 }))
-			count--;
-		if (!isMatchingBoard(p, { 37, 30, 23, 16 }))
-			count--;
-		if (!isMatchingBoard(p, { 30, 23, 16, 9 }))
-			count--;
-		if (!isMatchingBoard(p, { 23, 16, 9, 2 }))
-			count--;
-		break;
-	case 2:
-		count = 22;
-		if (!isMatchingBoard(p, { 0, 8, 16, 24 }))
-			count--;
-		if (!isMatchingBoard(p, { 22, 16, 10, 4 }))
-			count--;
-		if (!isMatchingBoard(p, { 14, 15, 16, 17 }))
-			count--;
-		if (!isMatchingBoard(p, { 15, 16, 17, 18 }))
-			count--;
-		if (!isMatchingBoard(p, { 16, 17, 18, 19 }))
-			count--;
-		if (!isMatchingBoard(p, { 8, 16, 24, 32 }))
-			count--;
-		if (!isMatchingBoard(p, { 28, 22, 16, 10 }))
-			count--;
-		if (!isMatchingBoard(p, { 16, 24, 32, 40 }))
-			count--;
-		if (!isMatchingBoard(p, { 37, 30, 23, 16 }))
-			count--;
-		if (!isMatchingBoard(p, { 30, 23, 16, 9 }))
-			count--;
-		if (!isMatchingBoard(p, { 23, 16, 9, 2 }))
-			count--;
-		break;
-	case 1:
-		count = 16;
-		if (!isMatchingBoard(p, { 7, 8, 9, 10 }))
-			count--;
-		if (!isMatchingBoard(p, { 8, 9, 10, 11 }))
-			count--;
-		if (!isMatchingBoard(p, { 9, 10, 11, 12 }))
-			count--;
-		if (!isMatchingBoard(p, { 1, 9, 17, 25 }))
-			count--;
-		if (!isMatchingBoard(p, { 21, 15, 9, 3 }))
-			count--;
-		if (!isMatchingBoard(p, { 9, 17, 25, 33 }))
-			count--;
-		if (!isMatchingBoard(p, { 30, 23, 16, 9 }))
-			count--;
-		if (!isMatchingBoard(p, { 23, 16, 9, 2 }))
-			count--;
-		break;
-	case 0:
-		count = 10;
-		if (!isMatchingBoard(p, { 0, 1, 2, 3 }))
-			count--;
-		if (!isMatchingBoard(p, { 1, 2, 3, 4 }))
-			count--;
-		if (!isMatchingBoard(p, { 2, 3, 4, 5 }))
-			count--;
-		if (!isMatchingBoard(p, { 2, 10, 18, 26 }))
-			count--;
-		if (!isMatchingBoard(p, { 23, 16, 9, 2 }))
-			count--;
-		break;
-	default: count = 0;
-	}
-	cn[2] = count;
-
-	switch (nextRow(3)) {
-	case 5:
-		count = 15;
-		if (!isMatchingBoard(p, { 14, 22, 30, 38 }))
-			count--;
-		if (!isMatchingBoard(p, { 38, 32, 26, 20 }))
-			count--;
-		if (!isMatchingBoard(p, { 35, 36, 37, 38 }))
-			count--;
-		if (!isMatchingBoard(p, { 36, 37, 38, 39 }))
-			count--;
-		if (!isMatchingBoard(p, { 37, 38, 39, 40 }))
-			count--;
-		if (!isMatchingBoard(p, { 38, 39, 40, 41 }))
-			count--;
-		if (!isMatchingBoard(p, { 38, 31, 24, 17 }))
-			count--;
-		break;
-	case 4:
-		count = 21;
-		if (!isMatchingBoard(p, { 7, 15, 23, 31 }))
-			count--;
-		if (!isMatchingBoard(p, { 31, 25, 19, 13 }))
-			count--;
-		if (!isMatchingBoard(p, { 15, 23, 31, 39 }))
-			count--;
-		if (!isMatchingBoard(p, { 37, 31, 25, 19 }))
-			count--;
-		if (!isMatchingBoard(p, { 28, 29, 30, 31 }))
-			count--;
-		if (!isMatchingBoard(p, { 29, 30, 31, 32 }))
-			count--;
-		if (!isMatchingBoard(p, { 30, 31, 32, 33 }))
-			count--;
-		if (!isMatchingBoard(p, { 31, 32, 33, 34 }))
-			count--;
-		if (!isMatchingBoard(p, { 38, 31, 24, 17 }))
-			count--;
-		if (!isMatchingBoard(p, { 31, 24, 17, 10 }))
-			count--;
-		break;
-	case 3:
-		count = 27;
-		if (!isMatchingBoard(p, { 0, 8, 16, 24 }))
-			count--;
-		if (!isMatchingBoard(p, { 24, 18, 12, 6 }))
-			count--;
-		if (!isMatchingBoard(p, { 8, 16, 24, 32 }))
-			count--;
-		if (!isMatchingBoard(p, { 30, 24, 18, 12 }))
-			count--;
-		if (!isMatchingBoard(p, { 21, 22, 23, 24 }))
-			count--;
-		if (!isMatchingBoard(p, { 22, 23, 24, 25 }))
-			count--;
-		if (!isMatchingBoard(p, { 23, 24, 25, 26 }))
-			count--;
-		if (!isMatchingBoard(p, { 24, 25, 26, 27 }))
-			count--;
-		if (!isMatchingBoard(p, { 16, 24, 32, 40 }))
-			count--;
-		if (!isMatchingBoard(p, { 36, 30, 24, 18 }))
-			count--;
-		if (!isMatchingBoard(p, { 38, 31, 24, 17 }))
-			count--;
-		if (!isMatchingBoard(p, { 31, 24, 17, 10 }))
-			count--;
-		if (!isMatchingBoard(p, { 24, 17, 10, 3 }))
-			count--;
-		break;
-	case 2:
-		count = 26;
-		if (!isMatchingBoard(p, { 1, 9, 17, 25 }))
-			count--;
-		if (!isMatchingBoard(p, { 23, 17, 11, 5 }))
-			count--;
-		if (!isMatchingBoard(p, { 14, 15, 16, 17 }))
-			count--;
-		if (!isMatchingBoard(p, { 15, 16, 17, 18 }))
-			count--;
-		if (!isMatchingBoard(p, { 16, 17, 18, 19 }))
-			count--;
-		if (!isMatchingBoard(p, { 17, 18, 19, 20 }))
-			count--;
-		if (!isMatchingBoard(p, { 9, 17, 25, 33 }))
-			count--;
-		if (!isMatchingBoard(p, { 29, 23, 17, 11 }))
-			count--;
-		if (!isMatchingBoard(p, { 17, 25, 33, 41 }))
-			count--;
-		if (!isMatchingBoard(p, { 35, 29, 23, 17 }))
-			count--;
-		if (!isMatchingBoard(p, { 38, 31, 24, 17 }))
-			count--;
-		if (!isMatchingBoard(p, { 31, 24, 17, 10 }))
-			count--;
-		if (!isMatchingBoard(p, { 24, 17, 10, 3 }))
-			count--;
-		break;
-	case 1:
-		count = 20;
-		if (!isMatchingBoard(p, { 7, 8, 9, 10 }))
-			count--;
-		if (!isMatchingBoard(p, { 8, 9, 10, 11 }))
-			count--;
-		if (!isMatchingBoard(p, { 9, 10, 11, 12 }))
-			count--;
-		if (!isMatchingBoard(p, { 10, 11, 12, 13 }))
-			count--;
-		if (!isMatchingBoard(p, { 2, 10, 18, 26 }))
-			count--;
-		if (!isMatchingBoard(p, { 22, 16, 10, 4 }))
-			count--;
-		if (!isMatchingBoard(p, { 10, 18, 26, 34 }))
-			count--;
-		if (!isMatchingBoard(p, { 28, 22, 16, 10 }))
-			count--;
-		if (!isMatchingBoard(p, { 31, 24, 17, 10 }))
-			count--;
-		if (!isMatchingBoard(p, { 24, 17, 10, 3 }))
-			count--;
-		break;
-	case 0:
-		count = 14;
-		if (!isMatchingBoard(p, { 0, 1, 2, 3 }))
-			count--;
-		if (!isMatchingBoard(p, { 1, 2, 3, 4 }))
-			count--;
-		if (!isMatchingBoard(p, { 2, 3, 4, 5 }))
-			count--;
-		if (!isMatchingBoard(p, { 3, 4, 5, 6 }))
-			count--;
-		if (!isMatchingBoard(p, { 3, 11, 19, 27 }))
-			count--;
-		if (!isMatchingBoard(p, { 21, 15, 9, 3 }))
-			count--;
-		if (!isMatchingBoard(p, { 24, 17, 10, 3 }))
-			count--;
-		break;
-	default: count = 0;
-	}
-	cn[3] = count;
+// Key of the left-right mirror image; the key never carries across columns so they can be swapped as is
+uint64_t Connect4::getMirroredKey() {
+	uint64_t key = getKey();
+	if (size == SIZE_6X7) return BoardShape<6, 7>::mirror(key);
 
-	switch (nextRow(4)) {
-	case 5:
-		count = 11;
-		if (!isMatchingBoard(p, { 15, 23, 31, 39 }))
-			count--;
-		if (!isMatchingBoard(p, { 36, 37, 38, 39 }))
-			count--;
-		if (!isMatchingBoard(p, { 37, 38, 39, 40 }))
-			count--;
-		if (!isMatchingBoard(p, { 38, 39, 40, 41 }))
-			count--;
-		if (!isMatchingBoard(p, { 39, 32, 25, 18 }))
-			count--;
-		break;
-	case 4:
-		count = 17;
-		if (!isMatchingBoard(p, { 8, 16, 24, 32 }))
-			count--;
-		if (!isMatchingBoard(p, { 16, 24, 32, 40 }))
-			count--;
-		if (!isMatchingBoard(p, { 38, 32, 26, 20 }))
-			count--;
-		if (!isMatchingBoard(p, { 29, 30, 31, 32 }))
-			count--;
-		if (!isMatchingBoard(p, { 30, 31, 32, 33 }))
-			count--;
-		if (!isMatchingBoard(p, { 31, 32, 33, 34 }))
-			count--;
-		if (!isMatchingBoard(p, { 39, 32, 25, 18 }))
-			count--;
-		if (!isMatchingBoard(p, { 32, 25, 18, 11 }))
-			count--;
-		break;
-	case 3:
-		count = 23;
-		if (!isMatchingBoard(p, { 1, 9, 17, 25 }))
-			count--;
-		if (!isMatchingBoard(p, { 9, 17, 25, 33 }))
-			count--;
-		if (!isMatchingBoard(p, { 31, 25, 19, 13 }))
-			count--;
-		if (!isMatchingBoard(p, { 22, 23, 24, 25 }))
-			count--;
-		if (!isMatchingBoard(p, { 23, 24, 25, 26 }))
-			count--;
-		if (!isMatchingBoard(p, { 24, 25, 26, 27 }))
-			count--;
-		if (!isMatchingBoard(p, { 17, 25, 33, 41 }))
-			count--;
-		if (!isMatchingBoard(p, { 37, 31, 25, 19 }))
-			count--;
-		if (!isMatchingBoard(p, { 39, 32, 25, 18 }))
-			count--;
-		if (!isMatchingBoard(p, { 32, 25, 18, 11 }))
-			count--;
-		if (!isMatchingBoard(p, { 25, 18, 11, 4 }))
-			count--;
-		break;
-	case 2:
-		count = 22;
-		if (!isMatchingBoard(p, { 2, 10, 18, 26 }))
-			count--;
-		if (!isMatchingBoard(p, { 24, 18, 12, 6 }))
-			count--;
-		if (!isMatchingBoard(p, { 15, 16, 17, 18 }))
-			count--;
-		if (!isMatchingBoard(p, { 16, 17, 18, 19 }))
-			count--;
-		if (!isMatchingBoard(p, { 17, 18, 19, 20 }))
-			count--;
-		if (!isMatchingBoard(p, { 10, 18, 26, 34 }))
-			count--;
-		if (!isMatchingBoard(p, { 30, 24, 18, 12 }))
-			count--;
-		if (!isMatchingBoard(p, { 36, 30, 24, 18 }))
-			count--;
-		if (!isMatchingBoard(p, { 39, 32, 25, 18 }))
-			count--;
-		if (!isMatchingBoard(p, { 32, 25, 18, 11 }))
-			count--;
-		if (!isMatchingBoard(p, { 25, 18, 11, 4 }))
-			count--;
-		break;
-	case 1:
-		count = 16;
-		if (!isMatchingBoard(p, { 8, 9, 10, 11 }))
-			count--;
-		if (!isMatchingBoard(p, { 9, 10, 11, 12 }))
-			count--;
-		if (!isMatchingBoard(p, { 10, 11, 12, 13 }))
-			count--;
-		if (!isMatchingBoard(p, { 3, 11, 19, 27 }))
-			count--;
-		if (!isMatchingBoard(p, { 23, 17, 11, 5 }))
-			count--;
-		if (!isMatchingBoard(p, { 29, 23, 17, 11 }))
-			count--;
-		if (!isMatchingBoard(p, { 32, 25, 18, 11 }))
-			count--;
-		if (!isMatchingBoard(p, { 25, 18, 11, 4 }))
-			count--;
-		break;
-	case 0:
-		count = 10;
-		if (!isMatchingBoard(p, { 1, 2, 3, 4 }))
-			count--;
-		if (!isMatchingBoard(p, { 2, 3, 4, 5 }))
-			count--;
-		if (!isMatchingBoard(p, { 3, 4, 5, 6 }))
-			count--;
-		if (!isMatchingBoard(p, { 22, 16, 10, 4 }))
-			count--;
-		if (!isMatchingBoard(p, { 25, 18, 11, 4 }))
-			count--;
-		break;
-	default: count = 0;
-	}
-	cn[4] = count;
+	uint64_t column = ((uint64_t)1 << (rows + 1)) - 1;
+	uint64_t mirrored = 0;
+	for (int i = 0; i < cols; i++)
+		mirrored |= ((key >> (i * (rows + 1))) & column) << ((cols - 1 - i) * (rows + 1));
+	return mirrored;
+}
 
-	switch (nextRow(5)) {
-	case 5:
-		count = 9;
-		if (!isMatchingBoard(p, { 16, 24, 32, 40 }))
-			count--;
-		if (!isMatchingBoard(p, { 37, 38, 39, 40 }))
-			count--;
-		if (!isMatchingBoard(p, { 38, 39, 40, 41 }))
-			count--;
-		if (!isMatchingBoard(p, { 40, 33, 26, 19 }))
-			count--;
-		break;
-	case 4:
-		count = 13;
-		if (!isMatchingBoard(p, { 9, 17, 25, 33 }))
-			count--;
-		if (!isMatchingBoard(p, { 17, 25, 33, 41 }))
-			count--;
-		if (!isMatchingBoard(p, { 30, 31, 32, 33 }))
-			count--;
-		if (!isMatchingBoard(p, { 31, 32, 33, 34 }))
-			count--;
-		if (!isMatchingBoard(p, { 40, 33, 26, 19 }))
-			count--;
-		if (!isMatchingBoard(p, { 33, 26, 19, 12 }))
-			count--;
-		break;
-	case 3:
-		count = 17;
-		if (!isMatchingBoard(p, { 2, 10, 18, 26 }))
-			count--;
-		if (!isMatchingBoard(p, { 10, 18, 26, 34 }))
-			count--;
-		if (!isMatchingBoard(p, { 23, 24, 25, 26 }))
-			count--;
-		if (!isMatchingBoard(p, { 24, 25, 26, 27 }))
-			count--;
-		if (!isMatchingBoard(p, { 38, 32, 26, 20 }))
-			count--;
-		if (!isMatchingBoard(p, { 40, 33, 26, 19 }))
-			count--;
-		if (!isMatchingBoard(p, { 33, 26, 19, 12 }))
-			count--;
-		if (!isMatchingBoard(p, { 26, 19, 12, 5 }))
-			count--;
-		break;
-	case 2:
-		count = 16;
-		if (!isMatchingBoard(p, { 3, 11, 19, 27 }))
-			count--;
-		if (!isMatchingBoard(p, { 16, 17, 18, 19 }))
-			count--;
-		if (!isMatchingBoard(p, { 17, 18, 19, 20 }))
-			count--;
-		if (!isMatchingBoard(p, { 31, 25, 19, 13 }))
-			count--;
-		if (!isMatchingBoard(p, { 37, 31, 25, 19 }))
-			count--;
-		if (!isMatchingBoard(p, { 40, 33, 26, 19 }))
-			count--;
-		if (!isMatchingBoard(p, { 33, 26, 19, 12 }))
-			count--;
-		if (!isMatchingBoard(p, { 26, 19, 12, 5 }))
-			count--;
-		break;
-	case 1:
-		count = 12;
-		if (!isMatchingBoard(p, { 9, 10, 11, 12 }))
-			count--;
-		if (!isMatchingBoard(p, { 10, 11, 12, 13 }))
-			count--;
-		if (!isMatchingBoard(p, { 24, 18, 12, 6 }))
-			count--;
-		if (!isMatchingBoard(p, { 30, 24, 18, 12 }))
-			count--;
-		if (!isMatchingBoard(p, { 33, 26, 19, 12 }))
-			count--;
-		if (!isMatchingBoard(p, { 26, 19, 12, 5 }))
-			count--;
-		break;
-	case 0:
-		count = 8;
-		if (!isMatchingBoard(p, { 2, 3, 4, 5 }))
-			count--;
-		if (!isMatchingBoard(p, { 3, 4, 5, 6 }))
-			count--;
-		if (!isMatchingBoard(p, { 23, 17, 11, 5 }))
-			count--;
-		if (!isMatchingBoard(p, { 26, 19, 12, 5 }))
-			count--;
-		break;
-	default: count = 0;
+void Connect4::setBoard(Connect4* board) {
+	position[PLAYER1] = board->position[PLAYER1];
+	position[PLAYER2] = board->position[PLAYER2];
+	mask = board->mask;
+	for (int i = 0; i < cols; i++)
+		heights[i] = board->heights[i];
+	availableSpaces = board->availableSpaces;
+	windowState = board->windowState;
+	for (int i = 0; i < 3; i++) {
+		windowScore[i] = board->windowScore[i];
+		fourCount[i] = board->fourCount[i];
 	}
-	cn[5] = count;
+}
 
-	switch (nextRow(6)) {
-	case 5:
-		count = 7;
-		if (!isMatchingBoard(p, { 17, 25, 33, 41 }))
-			count--;
-		if (!isMatchingBoard(p, { 38, 39, 40, 41 }))
-			count--;
-		if (!isMatchingBoard(p, { 41, 34, 27, 20 }))
-			count--;
-		break;
-	case 4:
-		count = 9;
-		if (!isMatchingBoard(p, { 10, 18, 26, 34 }))
-			count--;
-		if (!isMatchingBoard(p, { 31, 32, 33, 34 }))
-			count--;
-		if (!isMatchingBoard(p, { 41, 34, 27, 20 }))
-			count--;
-		if (!isMatchingBoard(p, { 34, 27, 20, 13 }))
-			count--;
-		break;
-	case 3:
-		count = 11;
-		if (!isMatchingBoard(p, { 3, 11, 19, 27 }))
-			count--;
-		if (!isMatchingBoard(p, { 24, 25, 26, 27 }))
-			count--;
-		if (!isMatchingBoard(p, { 41, 34, 27, 20 }))
-			count--;
-		if (!isMatchingBoard(p, { 34, 27, 20, 13 }))
-			count--;
-		if (!isMatchingBoard(p, { 27, 20, 13, 6 }))
-			count--;
-		break;
-	case 2:
-		count = 10;
-		if (!isMatchingBoard(p, { 17, 18, 19, 20 }))
-			count--;
-		if (!isMatchingBoard(p, { 38, 32, 26, 20 }))
-			count--;
-		if (!isMatchingBoard(p, { 41, 34, 27, 20 }))
-			count--;
-		if (!isMatchingBoard(p, { 34, 27, 20, 13 }))
-			count--;
-		if (!isMatchingBoard(p, { 27, 20, 13, 6 }))
-			count--;
-		break;
-	case 1:
-		count = 8;
-		if (!isMatchingBoard(p, { 10, 11, 12, 13 }))
-			count--;
-		if (!isMatchingBoard(p, { 31, 25, 19, 13 }))
-			count--;
-		if (!isMatchingBoard(p, { 34, 27, 20, 13 }))
-			count--;
-		if (!isMatchingBoard(p, { 27, 20, 13, 6 }))
-			count--;
-		break;
-	case 0:
-		count = 6;
-		if (!isMatchingBoard(p, { 3, 4, 5, 6 }))
-			count--;
-		if (!isMatchingBoard(p, { 24, 18, 12, 6 }))
-			count--;
-		if (!isMatchingBoard(p, { 27, 20, 13, 6 }))
-			count--;
-		break;
-	default: count = 0;
-	}
-	cn[6] = count;
+void Connect4::resetBoard() {
+	initBoard();
+	availableSpaces = rows * cols;
+	round = 1;
+	currentTurn = PLAYER2;
+	winner = NONE;
+	lastMove = { 0, 0 };
+}
 
-	// Sort
-	std::vector<int> moves(8);
-	do {
-		count = 0;
-		for (i = 6; i >= 0; i--) {
-			if (cn[i] > count) {
-				count = cn[i];
-				index = i;
-			}
-		}
-		cn[index] = 0;
-		moves[j++] = index;
-	} while (count != 0);
-	
-	// Remove all zero counts
-	while (moves.size() > 1 && moves.back() == 0) {
-		moves.pop_back();
-	}
+bool Connect4::isDraw() { 
+	return availableSpaces <= 0; 
+}
+// Whether a disc of the player in the empty cell (row, col) completes four in a row: some window
+// through the cell already holds three of the player's discs and none of the opponent's
+bool Connect4::canWin(int player, int col, int row) {
+	if (!validMove(row, col)) return false;
+	int index = cellIndex(row, col);
+	if (mask & ((uint64_t)1 << index)) return false;
 
-	return moves;
+	int threeOwnNoOther = 3 * WINDOW_STEP[player];
+	for (int i = cellWindowStart[index]; i < cellWindowStart[index + 1]; i++)
+		if (windowState[cellWindows[i]] == threeOwnNoOther)
+			return true;
+	return false;
 }
 
-bool Connect4::isMatchingBoard(int player, std::vector<int> winningPositions) {
-	for (int position : winningPositions) {
-		int row = position / cols;
-		int col = position % cols;
-		if (board[row][col] != player) {
-			return false;
+// Playable columns, best first, ordered by the number of windows through the cell each would fill;
+// cells in the lower half of the board win ties, then higher columns. Returns the number of moves
+int Connect4::generateTDLMoves(int* moves) {
+	int priority[MAX_COLS];
+	int count = 0;
+	for (int col = cols - 1; col >= 0; col--) {
+		if (heights[col] == rows) continue;
+		int index = col * (rows + 1) + heights[col];
+		int value = cellWindowStart[index + 1] - cellWindowStart[index] + (heights[col] < rows / 2);
+
+		// Insertion sort; columns are visited right to left so equal values keep the higher column first
+		int i = count++;
+		for (; i > 0 && priority[i - 1] < value; i--) {
+			moves[i] = moves[i - 1];
+			priority[i] = priority[i - 1];
 		}
+		moves[i] = col;
+		priority[i] = value;
 	}
-	return true;
+	return count;
 }
 
 std::pair<int, int> Connect4::getLastMove() { return lastMove; }
@@ -4,19 +4,38 @@
 // 10/26/2023
 //
 #pragma once
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <vector>
 #include <algorithm>
 #include "actor.h"
+#include "board-shape.h"
+
+// Widest board that fits the bitboard (one row plus the empty bit per column)
+constexpr int MAX_COLS = 32;
 
 class Connect4 {
 private:
-	// Board
-	int** board;
+	// Board (one bitboard per player, bit col * (rows + 1) + height from the bottom;
+	// the extra bit on top of every column is always empty so shifts never wrap)
+	uint64_t position[3] = { 0, 0, 0 };
+	uint64_t mask = 0;
+	uint64_t boardMask = 0;
+	int heights[MAX_COLS];
 	int cols;
 	int rows;
 	int availableSpaces;
+	BoardSize size = SIZE_CUSTOM;
+
+	// Evaluation windows (every line of four cells) with both players' disc counts,
+	// updated for the windows through a cell whenever a disc is added or removed;
+	// the per-cell lists double as the winning-line tables for canWin and generateTDLMoves
+	std::vector<int> cellWindowStart;
+	std::vector<int> cellWindows;
+	std::vector<uint8_t> windowState;
+	int windowScore[3] = { 0, 0, 0 };
+	int fourCount[3] = { 0, 0, 0 };
 
 	// Game management
 	int round = 1;
@@ -26,13 +45,20 @@ private:
 
 	// Utils
 	void initBoard();
+	void initWindows();
+	void updateWindows(int index, Actor actor, int delta);
 	bool validMove(int row, int col);
+	int cellIndex(int row, int col);
+	uint64_t cellBit(int row, int col);
 	std::string repeat(std::string s, int n);
 public:
 	// Constructors
 	Connect4();
 	Connect4(int rows, int cols);
-	~Connect4();
+
+	static bool fitsBitboard(int rows, int cols);
+	static int countBits(uint64_t bits);
+	bool alignment(uint64_t pos); // Four in a row in the given discs
 
 	// Game Functions
 	void printBoard();
@@ -55,17 +81,22 @@ public:
 	int getCell(int x, int y);
 	int getRows();
 	int getCols();
+	uint64_t getPosition(Actor a);
+	uint64_t getMask();
+	uint64_t getBoardMask();
+	uint64_t getKey();
+	uint64_t getMirroredKey();
+	int getWindowScore(Actor a);
+	int getFourCount(Actor a);
+	int countNewThreats(int row, int col, Actor a);
 
 	// Added from TDL
-	int** getBoard();
-	void setBoard(int** board);
+	void setBoard(Connect4* board);
 
 	void resetBoard();
-	int** getMirroredField(int** board);
 	bool isDraw();
 	bool canWin(int player, int col, int row);
-	bool isMatchingBoard(int player, std::vector<int> winningPositions);
-	std::vector<int> generateTDLMoves(int player);
+	int generateTDLMoves(int* moves);
 
 	std::pair<int, int> getLastMove();
 	void setLastMove(std::pair<int, int> p);
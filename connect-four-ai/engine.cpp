@@ -0,0 +1,201 @@
+// 
+// engine.cpp
+// Jake Buhite and Nick Abegg
+// 10/26/2023
+//
+#include "engine.h"
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+Engine::Engine(std::ostream& out, OpeningBook* book, Tablebase* tablebase) : out(out) {
+	this->book = book;
+	this->tablebase = tablebase;
+	newGame(rows, cols);
+}
+
+Engine::~Engine() { stop(); }
+
+// Weights of both players for eval, 6x7 only. Text weights load slowly but only once
+bool Engine::loadWeights(const std::string& player1, const std::string& player2) {
+	std::string files[3] = { "", player1, player2 };
+	if (!TDLAgent::weightsExist(player1) || !TDLAgent::weightsExist(player2)) return false;
+	for (int actor = PLAYER1; actor <= PLAYER2; actor++) {
+		tdl[actor].reset(new TDLAgent(false, actor, 0, 0));
+		tdl[actor]->loadAgent(files[actor]);
+	}
+	return true;
+}
+
+void Engine::run(std::istream& in) {
+	std::string line;
+	while (std::getline(in, line)) {
+		std::stringstream stream(line);
+		std::string command;
+		std::vector<std::string> args;
+		std::string arg;
+		stream >> command;
+		while (stream >> arg)
+			args.push_back(arg);
+
+		if (command.empty()) continue;
+		else if (command == "quit") {
+			stop();
+			return;
+		}
+		else if (command == "isready") send("readyok");
+		else if (command == "stop") stop();
+		else if (command == "go") go(args);
+		else if (command == "eval") eval();
+		else if (command == "position") setPosition(args);
+		else if (command == "newgame") {
+			if (args.size() == 2) newGame(std::atoi(args[0].c_str()), std::atoi(args[1].c_str()));
+			else newGame(rows, cols);
+		}
+		else send("info string unknown command " + command);
+	}
+	finish(); // End of input: the last search still completes
+}
+
+// Keeps the agents and their tables unless the board size changes
+void Engine::newGame(int rows, int cols) {
+	finish();
+	if (!Connect4::fitsBitboard(rows, cols)) {
+		send("info string unsupported board " + std::to_string(rows) + "x" + std::to_string(cols));
+		return;
+	}
+	if (board != nullptr && rows == this->rows && cols == this->cols) {
+		board->resetBoard();
+		board->incrementRound();
+		return;
+	}
+
+	this->rows = rows;
+	this->cols = cols;
+	board.reset(new Connect4(rows, cols));
+	board->incrementRound(); // Past the first round, where the menu games restrict moves
+	for (int actor = PLAYER1; actor <= PLAYER2; actor++) {
+		agents[actor].reset(new MiniMax(board.get(), ENGINE_DEFAULT_DEPTH, (Actor)actor));
+		agents[actor]->setOpeningBook(book);
+		agents[actor]->setTablebase(tablebase);
+		agents[actor]->setStopSignal(&stopSearch);
+	}
+}
+
+// The position is only changed when every move is legal
+bool Engine::setPosition(const std::vector<std::string>& moves) {
+	finish();
+	std::vector<int> columns;
+	for (const std::string& move : moves) {
+		if (move == "startpos") continue;
+		if (move.size() > 1 && cols <= 10) {
+			for (char digit : move)
+				columns.push_back(std::isdigit(digit) ? digit - '0' : -1);
+		}
+		else columns.push_back(std::isdigit(move[0]) ? std::atoi(move.c_str()) : -1);
+	}
+
+	Connect4 scratch(rows, cols);
+	Actor actor = PLAYER1;
+	for (int col : columns) {
+		int row = scratch.nextRow(col);
+		if (row == -1 || scratch.hasWinner()) {
+			send("info string illegal move " + std::to_string(col));
+			return false;
+		}
+		scratch.addDisc(row, col, actor);
+		actor = (actor == PLAYER1) ? PLAYER2 : PLAYER1;
+	}
+
+	board->resetBoard();
+	board->incrementRound();
+	actor = PLAYER1;
+	for (int col : columns) {
+		board->addDisc(board->nextRow(col), col, actor);
+		actor = (actor == PLAYER1) ? PLAYER2 : PLAYER1;
+	}
+	return true;
+}
+
+void Engine::go(const std::vector<std::string>& args) {
+	finish();
+	if (board->hasWinner() || board->isDraw()) {
+		send("bestmove none");
+		return;
+	}
+
+	// Without a depth the search deepens until the time or node budget runs out
+	Actor actor = toMove();
+	MiniMax* agent = agents[actor].get();
+	int depth = 0;
+	int moveTime = 0;
+	long long nodes = 0;
+	for (size_t i = 0; i + 1 < args.size(); i += 2) {
+		if (args[i] == "depth") depth = std::atoi(args[i + 1].c_str());
+		else if (args[i] == "movetime") moveTime = std::atoi(args[i + 1].c_str());
+		else if (args[i] == "nodes") nodes = std::atoll(args[i + 1].c_str());
+	}
+	if (depth <= 0) depth = (moveTime > 0 || nodes > 0) ? board->getAvailableSpaces() : ENGINE_DEFAULT_DEPTH;
+	agent->setDepth(depth);
+	agent->setMoveTime(moveTime);
+	agent->setNodeLimit(nodes);
+
+	stopSearch = false;
+	search = std::thread(&Engine::searchPosition, this, actor);
+}
+
+void Engine::searchPosition(Actor actor) {
+	MiniMax* agent = agents[actor].get();
+	int move = agent->getAgentMove();
+	SearchStats stats;
+	agent->getSearchStats(stats);
+
+	std::stringstream info;
+	info << "info depth " << stats.depthReached << " score " << stats.score << " nodes " << stats.nodes + stats.helperNodes
+		<< " time " << (long long)stats.elapsedMs << (stats.bookMove ? " book" : "");
+	send(info.str());
+	send("bestmove " + std::to_string(move));
+}
+
+// Static evaluations for the player to move: the window score of MiniMax, the TDL value
+// on 6x7 when weights are loaded and the exact score when the tablebase has the position
+void Engine::eval() {
+	finish();
+	if (board->hasWinner() || board->isDraw()) {
+		Actor winner = board->hasWinner() ? ((toMove() == PLAYER1) ? PLAYER2 : PLAYER1) : NONE;
+		send("info eval over winner " + std::to_string(winner));
+		return;
+	}
+
+	Actor actor = toMove();
+	Actor other = (actor == PLAYER1) ? PLAYER2 : PLAYER1;
+	std::stringstream info;
+	info << "info eval heuristic " << board->getWindowScore(actor) - board->getWindowScore(other);
+	if (tdl[actor] != nullptr && rows == 6 && cols == 7) {
+		int indices[TDL_NUM_INDICES];
+		tdl[actor]->getIndices(board.get(), indices);
+		info << " tdl " << std::tanh(tdl[actor]->sumWeights(indices, TDL_NUM_INDICES));
+	}
+	int score;
+	if (tablebase != nullptr && tablebase->lookup(board.get(), score)) info << " exact " << score;
+	send(info.str());
+}
+
+// Ends the running search; it still prints its best move before the thread finishes
+void Engine::stop() {
+	stopSearch = true;
+	finish();
+}
+
+// Waits for the running search, which uses the board, to complete
+void Engine::finish() {
+	if (search.joinable()) search.join();
+}
+
+void Engine::send(const std::string& line) {
+	std::lock_guard<std::mutex> guard(outLock);
+	out << line << std::endl;
+}
+
+Actor Engine::toMove() { return ((rows * cols - board->getAvailableSpaces()) % 2 == 0) ? PLAYER1 : PLAYER2; }
@@ -0,0 +1,69 @@
+// 
+// engine.h
+// Jake Buhite and Nick Abegg
+// 10/26/2023
+//
+#pragma once
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "connect-four.h"
+#include "minimax.h"
+#include "opening-book.h"
+#include "tablebase.h"
+#include "tdl-agent.h"
+
+constexpr auto ENGINE_DEFAULT_DEPTH = 9; // Depth of a go without limits
+
+// Line based engine protocol in the spirit of UCI, for a long running process driven by another
+// program. Commands:
+//   newgame [rows cols]       forget the game (and change the board size)
+//   position [moves...]       set the position from the empty board; moves are columns from 0,
+//                             either separated by spaces or as one string of digits
+//   go [depth d | movetime ms | nodes n]
+//                             search in the background, then print info and bestmove lines
+//   stop                      end the search early; it still reports its best move
+//   eval                      print the evaluations of the position for the player to move
+//   isready                   answered with readyok straight away, even during a search
+//   quit                      stop any search and exit; at the end of input a search completes
+// Other commands wait for a running search to complete before they touch the position.
+// The search tables, opening book, tablebase and TDL weights are kept for the whole session.
+// Games follow the standard rules, without the first round restriction of the menu games
+class Engine {
+private:
+	std::ostream& out;
+	std::mutex outLock;
+
+	int rows = 6;
+	int cols = 7;
+	std::unique_ptr<Connect4> board;
+	std::unique_ptr<MiniMax> agents[3]; // One per colour, each with its own table
+
+	// Shared read-only data, loaded once
+	OpeningBook* book;
+	Tablebase* tablebase;
+	std::unique_ptr<TDLAgent> tdl[3];
+
+	std::thread search;
+	std::atomic<bool> stopSearch{ false };
+
+	void newGame(int rows, int cols);
+	bool setPosition(const std::vector<std::string>& moves);
+	void go(const std::vector<std::string>& args);
+	void searchPosition(Actor actor);
+	void eval();
+	void stop();
+	void finish();
+	void send(const std::string& line);
+	Actor toMove();
+public:
+	Engine(std::ostream& out, OpeningBook* book, Tablebase* tablebase);
+	~Engine();
+
+	bool loadWeights(const std::string& player1, const std::string& player2);
+	void run(std::istream& in);
+};
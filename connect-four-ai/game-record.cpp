@@ -0,0 +1,120 @@
+// 
+// game-record.cpp
+// Jake Buhite and Nick Abegg
+// 10/26/2023
+//
+#include "game-record.h"
+#include <cstring>
+#include <iostream>
+
+static const char RECORD_MAGIC[4] = { 'C', '4', 'G', 'R' };
+static const uint32_t RECORD_VERSION = 1;
+
+GameRecordWriter::~GameRecordWriter() { close(); }
+
+// Appends to an existing file of the same board size, otherwise starts a new one
+bool GameRecordWriter::open(const std::string& fileName, int rows, int cols) {
+	close();
+	GameRecordHeader header;
+	std::memcpy(header.magic, RECORD_MAGIC, 4);
+	header.version = RECORD_VERSION;
+	header.rows = rows;
+	header.cols = cols;
+
+	std::ifstream existing(fileName, std::ios::in | std::ios::binary);
+	GameRecordHeader found;
+	bool append = existing.read((char*)&found, sizeof(found)).gcount() == sizeof(found);
+	existing.close();
+	if (append && std::memcmp(&found, &header, sizeof(header)) != 0) {
+		std::cout << fileName << " holds games of another board or format" << std::endl;
+		return false;
+	}
+
+	out.open(fileName, std::ios::out | std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+	if (out.fail()) {
+		std::cout << "Could not open " << fileName << std::endl;
+		return false;
+	}
+	if (!append) out.write((const char*)&header, sizeof(header));
+	packed = cols <= 16;
+	buffer.reserve(GAME_RECORD_BUFFER + 2 + GAME_RECORD_MAX_MOVES);
+	return true;
+}
+
+void GameRecordWriter::write(const uint8_t* moves, int count, Actor winner) {
+	std::lock_guard<std::mutex> guard(lock);
+	if (!out.is_open()) return;
+	buffer.push_back((char)count);
+	buffer.push_back((char)winner);
+	if (packed) {
+		for (int i = 0; i < count; i += 2)
+			buffer.push_back((char)(moves[i] | ((i + 1 < count) ? moves[i + 1] << 4 : 0)));
+	}
+	else buffer.insert(buffer.end(), moves, moves + count);
+	if (buffer.size() >= GAME_RECORD_BUFFER) writeBuffer();
+}
+
+void GameRecordWriter::flush() {
+	std::lock_guard<std::mutex> guard(lock);
+	if (out.is_open()) writeBuffer();
+}
+
+void GameRecordWriter::close() {
+	std::lock_guard<std::mutex> guard(lock);
+	if (!out.is_open()) return;
+	writeBuffer();
+	out.close();
+}
+
+void GameRecordWriter::writeBuffer() {
+	out.write(buffer.data(), buffer.size());
+	out.flush();
+	buffer.clear();
+}
+
+bool GameRecordReader::open(const std::string& fileName) {
+	header = nullptr;
+	if (!file.open(fileName)) return false;
+
+	const GameRecordHeader* h = (const GameRecordHeader*)file.data();
+	if (file.size() < sizeof(GameRecordHeader) || std::memcmp(h->magic, RECORD_MAGIC, 4) != 0 || h->version != RECORD_VERSION) {
+		std::cout << "Invalid game record file " << fileName << std::endl;
+		file.close();
+		return false;
+	}
+	header = h;
+	packed = h->cols <= 16;
+	rewind();
+	return true;
+}
+
+// Reads the next game; false at the end of the file or at a record cut short by an interrupted write
+bool GameRecordReader::next(GameRecord& record) {
+	if (end - cursor < 2) return false;
+	int count = cursor[0];
+	int bytes = packed ? (count + 1) / 2 : count;
+	if (count > GAME_RECORD_MAX_MOVES || cursor[1] > PLAYER2 || end - cursor < 2 + bytes) return false;
+
+	record.count = count;
+	record.winner = (Actor)cursor[1];
+	const uint8_t* moves = cursor + 2;
+	if (packed) {
+		for (int i = 0; i < bytes; i++) {
+			record.moves[2 * i] = moves[i] & 0xF;
+			record.moves[2 * i + 1] = moves[i] >> 4;
+		}
+	}
+	else std::memcpy(record.moves, moves, count);
+	cursor += 2 + bytes;
+	return true;
+}
+
+void GameRecordReader::rewind() {
+	if (header == nullptr) return;
+	cursor = (const uint8_t*)(header + 1);
+	end = (const uint8_t*)file.data() + file.size();
+}
+
+int GameRecordReader::getRows() { return (header == nullptr) ? 0 : header->rows; }
+
+int GameRecordReader::getCols() { return (header == nullptr) ? 0 : header->cols; }
@@ -0,0 +1,71 @@
+// 
+// game-record.h
+// Jake Buhite and Nick Abegg
+// 10/26/2023
+//
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "actor.h"
+#include "mapped-file.h"
+
+constexpr auto GAME_RECORD_BUFFER = 1 << 16; // Bytes buffered before the writer flushes
+constexpr auto GAME_RECORD_MAX_MOVES = 64;
+
+// Game record file: header, then per game the number of moves, the winner (NONE for a draw)
+// and the columns played from the empty board, two per byte (low nibble first) when the
+// board has at most 16 columns, otherwise one per byte
+struct GameRecordHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t rows;
+	uint32_t cols;
+};
+
+struct GameRecord {
+	int count;
+	Actor winner;
+	uint8_t moves[GAME_RECORD_MAX_MOVES];
+};
+
+// Appends games to a record file through a buffer that is written out whenever it fills up
+// and on close. Safe to share between threads
+class GameRecordWriter {
+private:
+	std::ofstream out;
+	std::mutex lock;
+	std::vector<char> buffer;
+	bool packed = true;
+
+	GameRecordWriter(const GameRecordWriter&) = delete;
+	GameRecordWriter& operator=(const GameRecordWriter&) = delete;
+
+	void writeBuffer();
+public:
+	GameRecordWriter() {}
+	~GameRecordWriter();
+
+	bool open(const std::string& fileName, int rows, int cols);
+	void write(const uint8_t* moves, int count, Actor winner);
+	void flush();
+	void close();
+};
+
+// Iterates the games of a memory mapped record file
+class GameRecordReader {
+private:
+	MappedFile file;
+	const GameRecordHeader* header = nullptr;
+	const uint8_t* cursor = nullptr;
+	const uint8_t* end = nullptr;
+	bool packed = true;
+public:
+	bool open(const std::string& fileName);
+	bool next(GameRecord& record);
+	void rewind();
+	int getRows();
+	int getCols();
+};
@@ -0,0 +1,84 @@
+// 
+// mapped-file.cpp
+// Jake Buhite and Nick Abegg
+// 10/26/2023
+//
+#include "mapped-file.h"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() {}
+
+MappedFile::~MappedFile() { close(); }
+
+bool MappedFile::open(const std::string& fileName) {
+	close();
+#ifdef _WIN32
+	HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) return false;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+		CloseHandle(file);
+		return false;
+	}
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping == NULL) {
+		CloseHandle(file);
+		return false;
+	}
+	view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == NULL) {
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+	fileHandle = file;
+	mappingHandle = mapping;
+	length = (size_t)fileSize.QuadPart;
+#else
+	descriptor = ::open(fileName.c_str(), O_RDONLY);
+	if (descriptor < 0) return false;
+	struct stat info;
+	if (fstat(descriptor, &info) != 0 || info.st_size == 0) {
+		close();
+		return false;
+	}
+	void* address = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, descriptor, 0);
+	if (address == MAP_FAILED) {
+		close();
+		return false;
+	}
+	view = address;
+	length = (size_t)info.st_size;
+#endif
+	return true;
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+	if (view != nullptr) UnmapViewOfFile(view);
+	if (mappingHandle != nullptr) CloseHandle(mappingHandle);
+	if (fileHandle != nullptr) CloseHandle(fileHandle);
+	mappingHandle = nullptr;
+	fileHandle = nullptr;
+#else
+	if (view != nullptr) munmap(const_cast<void*>(view), length);
+	if (descriptor >= 0) ::close(descriptor);
+	descriptor = -1;
+#endif
+	view = nullptr;
+	length = 0;
+}
+
+bool MappedFile::isOpen() { return view != nullptr; }
+
+const void* MappedFile::data() { return view; }
+
+size_t MappedFile::size() { return length; }
\ No newline at end of file
@@ -0,0 +1,33 @@
+// 
+// mapped-file.h
+// Jake Buhite and Nick Abegg
+// 10/26/2023
+//
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+private:
+	const void* view = nullptr;
+	size_t length = 0;
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#else
+	int descriptor = -1;
+#endif
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+public:
+	MappedFile();
+	~MappedFile();
+
+	bool open(const std::string& fileName);
+	void close();
+	bool isOpen();
+	const void* data();
+	size_t size();
+};
\ No newline at end of file
@@ -0,0 +1,249 @@
+// 
+// mcts.cpp
+// Jake Buhite and Nick Abegg
+// 10/26/2023
+//
+#include "mcts.h"
+#include <cmath>
+#include <cstdlib>
+
+MCTS::MCTS(Connect4* game, Actor player) : bitboard(game->getRows(), game->getCols()) {
+	this->game = game;
+	this->player = player;
+	opponent = (player == PLAYER1) ? PLAYER2 : PLAYER1;
+	rows = game->getRows();
+	cols = game->getCols();
+	seed = rand();
+
+	setPoolSize(1 << 20);
+}
+
+int MCTS::getAgentMove() {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	stats = SearchStats();
+	iterations = 0;
+	stopped = false;
+	deadline = start + std::chrono::milliseconds(moveTime);
+
+	// The root is the current position with this agent to move
+	rootPosition = { game->getPosition(player), game->getMask(), rows * cols - game->getAvailableSpaces() };
+	poolUsed = 1;
+	initNode(pool[0], -1, TERMINAL_NONE);
+	expand(0, rootPosition, true);
+	Node& root = pool[0];
+	if (root.state.load() != NODE_EXPANDED || root.childCount == 0) return -1;
+
+	// Nothing to search with a single move or a win in one
+	int forced = (root.childCount == 1) ? pool[root.firstChild].move : -1;
+	for (int i = 0; i < root.childCount && forced == -1; i++)
+		if (pool[root.firstChild + i].terminal == TERMINAL_WIN) forced = pool[root.firstChild + i].move;
+
+	if (forced == -1) {
+		std::vector<WorkerStats> workers(threads);
+		std::vector<std::thread> helpers;
+		for (int i = 1; i < threads; i++)
+			helpers.push_back(std::thread(&MCTS::searchWorker, this, i, &workers[i]));
+		searchWorker(0, &workers[0]);
+		for (std::thread& helper : helpers)
+			helper.join();
+
+		for (int i = 0; i < threads; i++) {
+			if (i == 0) stats.nodes = workers[i].iterations;
+			else stats.helperNodes += workers[i].iterations;
+			stats.depthReached = std::max(stats.depthReached, workers[i].depth);
+		}
+	}
+
+	// Most visited move, the better scoring one on ties
+	int best = root.firstChild;
+	for (int i = root.firstChild + 1; i < root.firstChild + root.childCount; i++) {
+		int visits = pool[i].visits.load();
+		int bestVisits = pool[best].visits.load();
+		if (visits > bestVisits || (visits == bestVisits && pool[i].score.load() > pool[best].score.load())) best = i;
+	}
+	stats.move = (forced != -1) ? forced : pool[best].move;
+	stats.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	return stats.move;
+}
+
+bool MCTS::getSearchStats(SearchStats& stats) {
+	stats = this->stats;
+	return true;
+}
+
+void MCTS::setMoveTime(int milliseconds) { moveTime = std::max(0, milliseconds); }
+
+void MCTS::setIterationLimit(long long iterations) { iterationLimit = std::max(0LL, iterations); }
+
+void MCTS::setThreads(int threads) { this->threads = std::max(1, threads); }
+
+void MCTS::setPoolSize(int nodes) {
+	poolSize = std::max(nodes, cols + 1);
+	pool.reset(new Node[poolSize]);
+}
+
+void MCTS::setSeed(unsigned int seed) { this->seed = seed; }
+
+void MCTS::setValueAgents(TDLAgent* player1, TDLAgent* player2) {
+	// The n-tuples of the TDL tables are laid out for the standard board
+	if (rows != 6 || cols != 7) {
+		std::cout << "TDL values need a 6x7 board, using random playouts instead" << std::endl;
+		return;
+	}
+	valueAgents[PLAYER1] = player1;
+	valueAgents[PLAYER2] = player2;
+}
+
+// One thread's share of the search: select down the shared tree, expand, evaluate and back up
+void MCTS::searchWorker(int index, WorkerStats* worker) {
+	std::mt19937 random(seed + index);
+	Connect4 scratch(rows, cols);
+	int path[MCTS_MAX_PATH];
+
+	while (!outOfBudget(iterations.fetch_add(1))) {
+		BitboardPosition p = rootPosition;
+		int current = 0;
+		int length = 0;
+		path[length++] = 0;
+		pool[0].visits.fetch_add(1);
+
+		while (pool[current].terminal == TERMINAL_NONE) {
+			Node& node = pool[current];
+
+			// Leaves grow children from their second visit on; one thread expands, the others play out
+			int state = node.state.load(std::memory_order_acquire);
+			if (state == NODE_LEAF && node.visits.load(std::memory_order_relaxed) > 1
+				&& node.state.compare_exchange_strong(state, NODE_EXPANDING)) {
+				expand(current, p, false);
+				state = node.state.load(std::memory_order_acquire);
+			}
+			if (state != NODE_EXPANDED) break;
+
+			// The visit counts before the result is in, as a virtual loss
+			current = selectChild(current);
+			pool[current].visits.fetch_add(1);
+			p = bitboard.play(p, bitboard.possible(p) & bitboard.columnMask(pool[current].move));
+			path[length++] = current;
+		}
+
+		// Back up the result, alternating between the two players' points of view
+		long long score = evaluate(p, path, length, &scratch, random);
+		for (int i = length - 1; i >= 0; i--) {
+			pool[path[i]].score.fetch_add(score, std::memory_order_relaxed);
+			score = 2 * MCTS_RESULT_SCALE - score;
+		}
+		worker->iterations++;
+		worker->depth = std::max(worker->depth, length - 1);
+	}
+}
+
+bool MCTS::outOfBudget(long long iteration) {
+	if (stopped.load(std::memory_order_relaxed)) return true;
+	long long limit = (iterationLimit == 0 && moveTime == 0) ? MCTS_DEFAULT_ITERATIONS : iterationLimit;
+	if (limit > 0 && iteration >= limit) stopped = true;
+	if (moveTime > 0 && (iteration & 63) == 0 && std::chrono::steady_clock::now() >= deadline) stopped = true;
+	return stopped.load(std::memory_order_relaxed);
+}
+
+void MCTS::initNode(Node& node, int move, int terminal) {
+	node.visits.store(0, std::memory_order_relaxed);
+	node.score.store(0, std::memory_order_relaxed);
+	node.state.store(NODE_LEAF, std::memory_order_relaxed);
+	node.firstChild = -1;
+	node.childCount = 0;
+	node.move = move;
+	node.terminal = terminal;
+}
+
+// Gives the node at index a child per legal move of p, taken from the pool as one block
+void MCTS::expand(int index, const BitboardPosition& p, bool root) {
+	Node& node = pool[index];
+	uint64_t next = bitboard.possible(p);
+	int moves[MAX_COLS];
+	int count = 0;
+	for (int col = 0; col < cols; col++)
+		if ((next & bitboard.columnMask(col)) && !(root && game->isDominateMove(col))) moves[count++] = col;
+
+	// When the first round's restriction leaves nothing, any column goes
+	if (count == 0)
+		for (int col = 0; col < cols; col++)
+			if (next & bitboard.columnMask(col)) moves[count++] = col;
+
+	int first = poolUsed.fetch_add(count);
+	if (first + count > poolSize) {
+		node.state.store(NODE_FULL, std::memory_order_release);
+		return;
+	}
+	for (int i = 0; i < count; i++) {
+		uint64_t move = next & bitboard.columnMask(moves[i]);
+		int terminal = game->alignment(p.current | move) ? TERMINAL_WIN : (p.moves + 1 == rows * cols) ? TERMINAL_DRAW : TERMINAL_NONE;
+		initNode(pool[first + i], moves[i], terminal);
+	}
+	node.firstChild = first;
+	node.childCount = count;
+	node.state.store(NODE_EXPANDED, std::memory_order_release);
+}
+
+// UCT: the child's mean score plus an exploration bonus that shrinks as it is visited; unvisited children first
+int MCTS::selectChild(int index) {
+	const Node& node = pool[index];
+	double logVisits = std::log((double)std::max(1, node.visits.load(std::memory_order_relaxed)));
+	int best = node.firstChild;
+	double bestValue = -1;
+	for (int i = node.firstChild; i < node.firstChild + node.childCount; i++) {
+		int visits = pool[i].visits.load(std::memory_order_relaxed);
+		if (visits == 0) return i;
+		double mean = pool[i].score.load(std::memory_order_relaxed) / (2.0 * MCTS_RESULT_SCALE * visits);
+		double value = mean + MCTS_EXPLORATION * std::sqrt(logVisits / visits);
+		if (value > bestValue) {
+			bestValue = value;
+			best = i;
+		}
+	}
+	return best;
+}
+
+// Score of the leaf at the end of path for the player who moved into it, p being its position
+long long MCTS::evaluate(const BitboardPosition& p, const int* path, int length, Connect4* scratch, std::mt19937& random) {
+	const Node& leaf = pool[path[length - 1]];
+	if (leaf.terminal == TERMINAL_WIN) return 2 * MCTS_RESULT_SCALE;
+	if (leaf.terminal == TERMINAL_DRAW) return MCTS_RESULT_SCALE;
+	if (valueAgents[PLAYER1] == nullptr) return rollout(p, random);
+
+	// Replay the path on a board the TDL tables can read
+	scratch->setBoard(game);
+	Actor actor = player;
+	for (int i = 1; i < length; i++) {
+		int col = pool[path[i]].move;
+		scratch->addDisc(scratch->nextRow(col), col, actor);
+		actor = (actor == PLAYER1) ? PLAYER2 : PLAYER1;
+	}
+
+	// The table of the player to move values the position for that player, unless its tablebase has it
+	double value;
+	if (!valueAgents[actor]->exactValue(scratch, value)) {
+		int indices[TDL_NUM_INDICES];
+		valueAgents[actor]->getIndices(scratch, indices);
+		value = std::tanh(valueAgents[actor]->sumWeights(indices, TDL_NUM_INDICES));
+	}
+	return (long long)((1 - value) * MCTS_RESULT_SCALE);
+}
+
+// Random playout from p, taking a winning move whenever there is one
+long long MCTS::rollout(BitboardPosition p, std::mt19937& random) {
+	bool leafPlayerToMove = false; // The player who moved into the leaf is not to move at p
+	uint64_t options[MAX_COLS];
+	while (p.moves < rows * cols) {
+		uint64_t next = bitboard.possible(p);
+		int count = 0;
+		for (int col = 0; col < cols; col++) {
+			uint64_t move = next & bitboard.columnMask(col);
+			if (!move) continue;
+			if (game->alignment(p.current | move)) return leafPlayerToMove ? 2 * MCTS_RESULT_SCALE : 0;
+			options[count++] = move;
+		}
+		p = bitboard.play(p, options[random() % count]);
+		leafPlayerToMove = !leafPlayerToMove;
+	}
+	return MCTS_RESULT_SCALE;
+}
@@ -0,0 +1,90 @@
+// 
+// mcts.h
+// Jake Buhite and Nick Abegg
+// 10/26/2023
+//
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <thread>
+#include "agent.h"
+#include "bitboard-position.h"
+#include "connect-four.h"
+#include "tdl-agent.h"
+
+constexpr auto MCTS_EXPLORATION = 1.41421356; // UCT exploration constant
+constexpr auto MCTS_RESULT_SCALE = 1024; // Score of a draw; a win scores twice this
+constexpr auto MCTS_DEFAULT_ITERATIONS = 100000; // Budget when neither time nor iterations are set
+constexpr auto MCTS_MAX_PATH = 65; // Root plus one node per cell of the largest board
+
+// Monte Carlo tree search with UCT selection. All threads grow one tree held in a preallocated
+// node pool; a thread passing through a node counts as a visit without reward until its result
+// is backed up (virtual loss), which steers the other threads to different lines
+class MCTS : public Agent {
+private:
+	enum NodeState { NODE_LEAF = 0, NODE_EXPANDING = 1, NODE_EXPANDED = 2, NODE_FULL = 3 };
+	enum Terminal { TERMINAL_NONE = 0, TERMINAL_WIN = 1, TERMINAL_DRAW = 2 };
+
+	struct Node {
+		std::atomic<int> visits;
+		std::atomic<long long> score; // For the player who moved into the node
+		std::atomic<int> state;
+		int firstChild;
+		int childCount;
+		int move;
+		int terminal; // For the player who moved into the node
+	};
+
+	struct WorkerStats {
+		long long iterations = 0;
+		int depth = 0;
+	};
+
+	Connect4* game;
+	Actor player;
+	Actor opponent;
+	int rows;
+	int cols;
+	BitboardMoves bitboard;
+	BitboardPosition rootPosition;
+
+	// Node pool, reset for every move
+	std::unique_ptr<Node[]> pool;
+	int poolSize = 0;
+	std::atomic<int> poolUsed{ 0 };
+
+	// Search budget (0 = unlimited; MCTS_DEFAULT_ITERATIONS when neither is set) and threads
+	int moveTime = 0;
+	long long iterationLimit = 0;
+	int threads = 1;
+	unsigned int seed;
+	std::atomic<long long> iterations{ 0 };
+	std::atomic<bool> stopped{ false };
+	std::chrono::steady_clock::time_point deadline;
+
+	// Optional leaf evaluation by the TDL tables of each player instead of random playouts
+	TDLAgent* valueAgents[3] = { nullptr, nullptr, nullptr };
+
+	SearchStats stats;
+
+	void searchWorker(int index, WorkerStats* worker);
+	void initNode(Node& node, int move, int terminal);
+	bool outOfBudget(long long iteration);
+	void expand(int index, const BitboardPosition& p, bool root);
+	int selectChild(int index);
+	long long evaluate(const BitboardPosition& p, const int* path, int length, Connect4* scratch, std::mt19937& random);
+	long long rollout(BitboardPosition p, std::mt19937& random);
+public:
+	MCTS(Connect4* game, Actor player);
+
+	int getAgentMove();
+	bool getSearchStats(SearchStats& stats);
+	void setMoveTime(int milliseconds);
+	void setIterationLimit(long long iterations);
+	void setThreads(int threads);
+	void setPoolSize(int nodes);
+	void setSeed(unsigned int seed);
+	void setValueAgents(TDLAgent* player1, TDLAgent* player2);
+};
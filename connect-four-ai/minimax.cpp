@@ -10,6 +10,8 @@ MiniMax::MiniMax() {
 	player = PLAYER1;
 	opponent = PLAYER2;
 	maxDepth = 7;
+	table = std::make_shared<TranspositionTable>();
+	resetOrdering();
 }
 
 MiniMax::MiniMax(Connect4* game) : MiniMax() {
@@ -20,144 +22,393 @@ MiniMax::MiniMax(Connect4* game) : MiniMax() {
 MiniMax::MiniMax(Connect4* game, int depth, Actor player) : MiniMax(game) {
 	this->player = player;
 	this->opponent = (player == PLAYER1) ? PLAYER2 : PLAYER1;
-	maxDepth = (depth % 2 == 0) ? (depth - 1) : depth; // Ensure that depth is odd 
+	this->maxDepth = (depth % 2 == 0) ? (depth - 1) : depth; // Ensure that depth is odd 
 }
 
-int MiniMax::getAgentMove() { return miniMax(INT_MIN, INT_MAX); }
+MiniMax::~MiniMax() { stopPondering(); }
 
-int MiniMax::miniMax(int alpha, int beta) { return maxValue(alpha, beta, maxDepth).second; }
+MiniMax::MiniMax(MiniMax* main, Connect4* board) {
+	game = board;
+	player = main->player;
+	opponent = main->opponent;
+	maxDepth = main->maxDepth;
+	optimalMoveOrder = main->optimalMoveOrder;
+	table = main->table;
+	tablebase = main->tablebase;
+	resetOrdering();
+}
+
+int MiniMax::getAgentMove() {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	stats = SearchStats();
+	helperNodes = 0;
+
+	int bookMove, bookScore;
+	if (book != nullptr && book->lookup(game, bookMove, bookScore) && !game->isDominateMove(bookMove)) {
+		stats.move = bookMove;
+		stats.bookMove = true;
+		stats.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		return bookMove;
+	}
+
+	// Entries searched under the first round's restricted moves are not valid afterwards
+	bool restricted = game->isDominateMove(0);
+	if (restricted || lastSearchRestricted) table->clear();
+	lastSearchRestricted = restricted;
+
+	// Killers belong to the last position; history carries over at half weight
+	for (int i = 0; i < MAX_PLY; i++)
+		killers[i][0] = killers[i][1] = -1;
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 64; j++)
+			history[i][j] /= 2;
+
+	long long allocationsBefore = threadAllocations();
+	stats.move = miniMax(INT_MIN, INT_MAX);
+
+	// Starting helper threads allocates, the single-threaded search never does once warmed up
+	assert(!warmedUp || threads > 1 || threadAllocations() == allocationsBefore);
+	warmedUp = true;
+
+	stats.nodes = nodes;
+	stats.helperNodes = helperNodes;
+	if (stats.betaCutoffs > 0) stats.firstMoveCutoffRate = (double)stats.firstMoveCutoffs / stats.betaCutoffs;
+	stats.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	return stats.move;
+}
+
+void MiniMax::setTableSize(size_t megabytes) { table->resize(megabytes); }
+
+void MiniMax::setMoveTime(int milliseconds) { moveTime = milliseconds; }
+
+void MiniMax::setNodeLimit(long long nodes) { nodeLimit = nodes; }
+
+// Unlike the constructor, takes the depth as given
+void MiniMax::setDepth(int depth) { maxDepth = depth; }
+
+void MiniMax::setStopSignal(std::atomic<bool>* signal) { stopSignal = signal; }
+
+void MiniMax::setThreads(int threads) { this->threads = std::max(1, threads); }
+
+void MiniMax::setOpeningBook(OpeningBook* book) { this->book = book; }
+
+void MiniMax::setTablebase(Tablebase* tablebase) { this->tablebase = tablebase; }
+
+bool MiniMax::getSearchStats(SearchStats& stats) {
+	stats = this->stats;
+	return true;
+}
+
+void MiniMax::startPondering() {
+	stopPondering();
+
+	// First round entries are cleared before the next move, so there is nothing to gain then
+	if (game->isDominateMove(0)) return;
+	if (lastSearchRestricted) table->clear();
+	lastSearchRestricted = false;
+	ponderBoard.reset(new Connect4(*game));
+	ponderStop = false;
+	ponderThread = std::thread(&MiniMax::ponderSearch, this);
+}
+
+void MiniMax::stopPondering() {
+	if (!ponderThread.joinable()) return;
+	ponderStop = true;
+	ponderThread.join();
+}
+
+int MiniMax::miniMax(int alpha, int beta) {
+	nodes = 0;
+	stopped = false;
+	budgetArmed = false;
+	deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(moveTime);
+
+	// Start the helpers, each on its own copy of the board
+	std::atomic<bool> stopHelpers(false);
+	std::vector<Connect4> boards(threads - 1, *game);
+	std::vector<std::thread> helpers;
+	for (int i = 1; i < threads; i++)
+		helpers.push_back(std::thread(&MiniMax::helperSearch, this, &boards[i - 1], i, &stopHelpers));
+
+	// Iterative deepening: each iteration seeds the move ordering of the next through the table
+	int bestMove = -1;
+	long long previousIterationNodes = 0;
+	for (int depth = 1; depth <= maxDepth; depth++) {
+		rootDepth = depth;
+		long long iterationStart = nodes;
+		std::pair<int, int> result = maxValue(alpha, beta, depth);
+		if (stopped) break;
+		bestMove = result.second;
+		stats.score = result.first;
+		budgetArmed = true; // The first iteration always completes
+
+		long long iterationNodes = nodes - iterationStart;
+		if (previousIterationNodes > 0) stats.branchingFactor = (double)iterationNodes / previousIterationNodes;
+		previousIterationNodes = iterationNodes;
+		stats.depthReached = depth;
+
+		// A forced win or loss will not change with more depth
+		if (result.first >= AI_WIN || result.first <= PLAYER_WIN) break;
+	}
+
+	stopHelpers = true;
+	for (std::thread& helper : helpers)
+		helper.join();
+	return bestMove;
+}
+
+void MiniMax::helperSearch(Connect4* board, int index, std::atomic<bool>* stop) {
+	MiniMax helper(this, board);
+	helper.sharedStop = stop;
+
+	// Stagger the depths so that helpers fill the table ahead of the main search
+	for (int depth = 1 + index % 2; depth <= maxDepth && !helper.stopped; depth++) {
+		helper.rootDepth = depth;
+		helper.maxValue(INT_MIN, INT_MAX, depth);
+	}
+	helperNodes += helper.nodes;
+}
+
+// Searches the position after each reply of the opponent as getAgentMove would, the reply the
+// last search expected first, so that after the actual reply the root is already in the table
+void MiniMax::ponderSearch() {
+	MiniMax ponder(this, ponderBoard.get());
+	ponder.sharedStop = &ponderStop;
+	Connect4* board = ponderBoard.get();
+
+	int replies[MAX_COLS];
+	int count = ponder.getValidActions(replies);
+	TTEntry entry;
+	ponder.orderMoves(replies, count, table->probe(board->getKey(), entry) ? entry.move : -1, 0, opponent);
+	for (int i = 0; i < count && replies[i] != -1 && !ponder.stopped; i++) {
+		int row = board->nextRow(replies[i]);
+		board->addDisc(row, replies[i], opponent);
+		for (int depth = 1; depth <= maxDepth && !ponder.stopped && !board->hasWinner() && !board->isDraw(); depth++) {
+			ponder.rootDepth = depth;
+			ponder.maxValue(INT_MIN, INT_MAX, depth);
+		}
+		board->removeDisc(row, replies[i]);
+	}
+}
+
+bool MiniMax::outOfBudget() {
+	nodes++;
+	if (sharedStop != nullptr && sharedStop->load(std::memory_order_relaxed)) stopped = true;
+	if (!budgetArmed) return stopped;
+	if (stopSignal != nullptr && stopSignal->load(std::memory_order_relaxed)) stopped = true;
+	if (nodeLimit > 0 && nodes >= nodeLimit) stopped = true;
+	if (moveTime > 0 && (nodes & 1023) == 0 && std::chrono::steady_clock::now() >= deadline) stopped = true;
+	return stopped;
+}
 
 std::pair<int, int> MiniMax::minValue(int alpha, int beta, int depth) {
-	std::vector<int> actions = getValidActions();
-	if (game->hasWinner() || game->isDraw() || depth <= 0) return { utility(depth), -1 };
+	if (outOfBudget()) return { 0, -1 };
+	if (game->hasWinner() || game->isDraw()) return { utility(depth), -1 };
+
+	// Before the depth cutoff, so that leaves inside the tablebase are exact too
+	int exact;
+	if (probeTablebase(depth, opponent, exact)) return { exact, -1 };
+	if (depth <= 0) return { utility(depth), -1 };
+
+	// Use a stored result when it was searched at least this deep
+	uint64_t key = game->getKey();
+	TTEntry entry;
+	int ttMove = -1;
+	if (table->probe(key, entry)) {
+		entry.score = scoreFromTable(entry.score, depth);
+		if (entry.depth >= depth) {
+			if (entry.bound == BOUND_EXACT) return { entry.score, entry.move };
+			if (entry.bound == BOUND_LOWER) alpha = std::max(alpha, entry.score);
+			else if (entry.bound == BOUND_UPPER) beta = std::min(beta, entry.score);
+			if (alpha >= beta) return { entry.score, entry.move };
+		}
+		ttMove = entry.move;
+	}
+	int actions[MAX_COLS];
+	int count = getValidActions(actions);
+	orderMoves(actions, count, ttMove, depth, opponent);
+	int betaOrig = beta;
+
 	std::pair<int, int> bestMove = { INT_MAX, actions[0] };
-	for (int move : actions) {
+	for (int i = 0; i < count; i++) {
+		int move = actions[i];
 		int row = game->nextRow(move);
 		game->addDisc(row, move, opponent);
 		int newValue = maxValue(alpha, beta, depth - 1).first;
 		game->removeDisc(row, move);
+		if (stopped) return { 0, -1 };
 		if (newValue < bestMove.first) bestMove = { newValue, move };
 		beta = std::min(beta, bestMove.first);
-		if (alpha >= beta) break;
+		if (alpha >= beta) {
+			recordCutoff(move, depth, opponent, i == 0);
+			break;
+		}
 	}
+
+	Bound bound = (bestMove.first <= alpha) ? BOUND_UPPER : (bestMove.first >= betaOrig) ? BOUND_LOWER : BOUND_EXACT;
+	table->store(key, scoreToTable(bestMove.first, depth), depth, bound, bestMove.second);
 	return bestMove;
 }
 
 std::pair<int, int> MiniMax::maxValue(int alpha, int beta, int depth) {
-	std::vector<int> actions = getValidActions();
-	if (game->hasWinner() || game->isDraw() || depth <= 0) return { utility(depth), -1 };
+	if (outOfBudget()) return { 0, -1 };
+	if (game->hasWinner() || game->isDraw()) return { utility(depth), -1 };
+
+	// Before the depth cutoff, so that leaves inside the tablebase are exact too
+	int exact;
+	if (probeTablebase(depth, player, exact)) return { exact, -1 };
+	if (depth <= 0) return { utility(depth), -1 };
+
+	// Use a stored result when it was searched at least this deep
+	uint64_t key = game->getKey();
+	TTEntry entry;
+	int ttMove = -1;
+	if (table->probe(key, entry)) {
+		entry.score = scoreFromTable(entry.score, depth);
+		if (entry.depth >= depth) {
+			if (entry.bound == BOUND_EXACT) return { entry.score, entry.move };
+			if (entry.bound == BOUND_LOWER) alpha = std::max(alpha, entry.score);
+			else if (entry.bound == BOUND_UPPER) beta = std::min(beta, entry.score);
+			if (alpha >= beta) return { entry.score, entry.move };
+		}
+		ttMove = entry.move;
+	}
+	int actions[MAX_COLS];
+	int count = getValidActions(actions);
+	orderMoves(actions, count, ttMove, depth, player);
+	int alphaOrig = alpha;
+
 	std::pair<int, int> bestMove = { INT_MIN, actions[0] };
-	for (int move : actions) {
+	for (int i = 0; i < count; i++) {
+		int move = actions[i];
 		int row = game->nextRow(move);
 		game->addDisc(row, move, player);
 		int newValue = minValue(alpha, beta, depth - 1).first;
 		game->removeDisc(row, move);
+		if (stopped) return { 0, -1 };
 		if (newValue > bestMove.first) bestMove = { newValue, move };
 		alpha = std::max(alpha, bestMove.first);
-		if (alpha >= beta) break;
+		if (alpha >= beta) {
+			recordCutoff(move, depth, player, i == 0);
+			break;
+		}
 	}
+
+	Bound bound = (bestMove.first <= alphaOrig) ? BOUND_UPPER : (bestMove.first >= beta) ? BOUND_LOWER : BOUND_EXACT;
+	table->store(key, scoreToTable(bestMove.first, depth), depth, bound, bestMove.second);
 	return bestMove;
 }
 
-std::vector<int> MiniMax::getValidActions() {
-	std::vector<int> actions;
-	for (int i = 0; i < optimalMoveOrder.size(); i++)
+// Fills actions (room for every column) in the static order and returns their number
+int MiniMax::getValidActions(int* actions) {
+	int count = 0;
+	for (size_t i = 0; i < optimalMoveOrder.size(); i++)
 		if (!game->isDominateMove(optimalMoveOrder[i]) && !game->getCell(0, optimalMoveOrder[i]))
-			actions.push_back(optimalMoveOrder[i]);
-	if (actions.empty()) return { -1 };
-	return actions;
+			actions[count++] = optimalMoveOrder[i];
+	if (count == 0) actions[count++] = -1;
+	return count;
 }
 
-int MiniMax::utility(int depth) {
-	int opponentScore = nInARow(opponent);
-	int playerScore = nInARow(player);
-
-	if (opponentScore == PLAYER_WIN) return opponentScore - depth;
-	else if (playerScore == AI_WIN) { return playerScore + depth; }
-	else if (game->getAvailableSpaces() == 0) return 0;
+void MiniMax::orderMoves(int* actions, int count, int ttMove, int depth, Actor actor) {
+	if (actions[0] == -1) return;
+	int ply = std::min(rootDepth - depth, MAX_PLY - 1);
+	int cols = game->getCols();
 
-	return playerScore - opponentScore;
-}
+	// Table move first, then moves creating the most open threes, then killers, then history
+	int scores[MAX_COLS];
+	for (int i = 0; i < count; i++) {
+		int col = actions[i];
+		int row = game->nextRow(col);
+		int score = std::min(history[actor][row * cols + col], (1 << 20) - 1);
+		if (col == killers[ply][0]) score += 2 << 20;
+		else if (col == killers[ply][1]) score += 1 << 20;
+		score += game->countNewThreats(row, col, actor) << 22;
+		if (col == ttMove) score = INT_MAX;
 
-int MiniMax::nInARow(Actor player) {
-	int score = 0;
-	int cols = game->getCols();
-	int rows = game->getRows();
-
-	// Check vertical n in a row
-	for (int i = 0; i < cols; i++) {
-		for (int j = 0; j < rows - 3; j++) {
-			int n = 0;
-			int emptyCells = 0;
-			for (int k = 0; k < 4; k++) {
-				if (game->getCell(j + k, i) == player) n++;
-				else if (game->getCell(j + k, i) == 0) emptyCells++;
-				else break;
-			}
-			if (n == 4) return (player == this->player) ? AI_WIN : PLAYER_WIN;
-			else if (n == 3 && emptyCells == 1) score += 1000;
-			else if (n == 2 && emptyCells == 2) score += 100;
+		// Insertion sort, stable so that ties keep the static column order
+		int j = i;
+		for (; j > 0 && scores[j - 1] < score; j--) {
+			scores[j] = scores[j - 1];
+			actions[j] = actions[j - 1];
 		}
+		scores[j] = score;
+		actions[j] = col;
 	}
+}
 
-	// Check horizontal n in a row
-	for (int i = 0; i < rows; i++) {
-		for (int j = 0; j < cols - 3; j++) {
-			int n = 0;
-			int emptyCells = 0;
-			for (int k = 0; k < 4; k++) {
-				if (game->getCell(i, j + k) == player) n++;
-				else if (game->getCell(i, j + k) == 0) emptyCells++;
-				else break;
-			}
-			if (n == 4) return (player == this->player) ? AI_WIN : PLAYER_WIN;
-			else if (n == 3 && emptyCells == 1) score += 1000;
-			else if (n == 2 && emptyCells == 2) score += 100;
-		}
-	}
+void MiniMax::recordCutoff(int move, int depth, Actor actor, bool firstMove) {
+	stats.betaCutoffs++;
+	if (firstMove) stats.firstMoveCutoffs++;
 
-	// Check diagonal n in a row
-	for (int i = 0; i < rows - 3; i++) {
-		for (int j = 0; j < cols - 3; j++) {
-			int n = 0;
-			int emptyCells = 0;
-			for (int k = 0; k < 4; k++) {
-				if (game->getCell(i + k, j + k) == player) n++;
-				else if (game->getCell(i + k, j + k) == 0) emptyCells++;
-				else break;
-			}
-			if (n == 4) return (player == this->player) ? AI_WIN : PLAYER_WIN;
-			else if (n == 3 && emptyCells == 1) score += 1000;
-			else if (n == 2 && emptyCells == 2) score += 100;
-
-			n = 0;
-			emptyCells = 0;
-			for (int k = 0; k < 4; k++) {
-				if (game->getCell(i + k, j + 3 - k) == player) n++;
-				else if (game->getCell(i + k, j + 3 - k) == 0) emptyCells++;
-				else break;
-			}
-			if (n == 4) return (player == this->player) ? AI_WIN : PLAYER_WIN;
-			else if (n == 3 && emptyCells == 1) score += 1000;
-			else if (n == 2 && emptyCells == 2) score += 100;
-		}
+	int ply = std::min(rootDepth - depth, MAX_PLY - 1);
+	if (killers[ply][0] != move) {
+		killers[ply][1] = killers[ply][0];
+		killers[ply][0] = move;
 	}
+	int row = game->nextRow(move);
+	history[actor][row * game->getCols() + move] += depth * depth;
+}
+
+void MiniMax::resetOrdering() {
+	for (int i = 0; i < MAX_PLY; i++)
+		killers[i][0] = killers[i][1] = -1;
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 64; j++)
+			history[i][j] = 0;
+}
+
+// Win and loss scores count the depth left at the end of the game, so the same position scores
+// differently at another remaining depth. The table holds them relative to the node instead
+int MiniMax::scoreToTable(int score, int depth) {
+	if (score >= AI_WIN - MATE_RANGE && score <= AI_WIN + MATE_RANGE) return score - depth;
+	if (score <= PLAYER_WIN + MATE_RANGE && score >= PLAYER_WIN - MATE_RANGE) return score + depth;
+	return score;
+}
 
+int MiniMax::scoreFromTable(int score, int depth) {
+	if (score >= AI_WIN - MATE_RANGE && score <= AI_WIN + MATE_RANGE) return score + depth;
+	if (score <= PLAYER_WIN + MATE_RANGE && score >= PLAYER_WIN - MATE_RANGE) return score - depth;
 	return score;
 }
 
+int MiniMax::utility(int depth) {
+	stats.leafEvaluations++;
+	if (game->getFourCount(opponent) > 0) return PLAYER_WIN - depth;
+	else if (game->getFourCount(player) > 0) { return AI_WIN + depth; }
+	else if (game->getAvailableSpaces() == 0) return 0;
+
+	return game->getWindowScore(player) - game->getWindowScore(opponent);
+}
+
+// Exact value of a late position from the tablebase, scored like the win the search would find
+// at the end of the game: a win (or loss) plies moves away at depth is worth AI_WIN + depth - plies.
+// Not at the root, which needs a move: there the search picks it from the values of the children
+bool MiniMax::probeTablebase(int depth, Actor toMove, int& value) {
+	int score;
+	if (tablebase == nullptr || depth == rootDepth || !tablebase->lookup(game, score)) return false;
+	stats.tablebaseHits++;
+	if (score == 0) {
+		value = 0;
+		return true;
+	}
+	int remaining = depth - Solver::pliesToEnd(game, score);
+	value = ((score > 0) == (toMove == player)) ? AI_WIN + remaining : PLAYER_WIN - remaining;
+	return true;
+}
+
 void MiniMax::generateOptimalMoveOrder() {
-	std::vector<int> moves = { 2, 4, 5, 3, 1, 0, 6 }; //= {2, 3, 4, 1, 5, 0, 6};
+	// Static order used to break ties in orderMoves
+	std::vector<int> moves;
 
 	// Add center columns first
-	//int center = game->getCols() / 2;
-	//moves.push_back(center);
-
-	//// Add columns in order relative to their distance to the center column
-	//for (int i = 1; i <= center; i++) {
-	//	moves.push_back(center - i);
-	//	moves.push_back(center + i);
-	//}
+	int center = game->getCols() / 2;
+	moves.push_back(center);
+
+	// Add columns in order relative to their distance to the center column
+	for (int i = 1; i <= center; i++) {
+		if (center - i >= 0) moves.push_back(center - i);
+		if (center + i < game->getCols()) moves.push_back(center + i);
+	}
 
 	optimalMoveOrder = moves;
 }
\ No newline at end of file
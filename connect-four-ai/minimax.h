@@ -4,24 +4,81 @@
 // 10/26/2023
 //
 #pragma once
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <climits>
+#include <memory>
+#include <thread>
 #include "agent.h"
+#include "alloc-counter.h"
 #include "connect-four.h"
+#include "opening-book.h"
+#include "solver.h"
+#include "tablebase.h"
+#include "transposition-table.h"
 
 constexpr auto AI_WIN = 9999999;
 constexpr auto PLAYER_WIN = -9999999;
+constexpr auto MAX_PLY = 64;
+constexpr auto MATE_RANGE = 1000; // Win and loss scores lie within this of AI_WIN and PLAYER_WIN
 
 class MiniMax : public Agent {
 private:
 	int maxDepth;
 	Connect4* game;
 	std::vector<int> optimalMoveOrder;
+	std::shared_ptr<TranspositionTable> table;
+	bool lastSearchRestricted = false;
+	OpeningBook* book = nullptr;
+	Tablebase* tablebase = nullptr;
+
+	// Dynamic move ordering: killer columns per ply and a history score per player and cell
+	int killers[MAX_PLY][2];
+	int history[3][64];
+	int rootDepth = 0;
+
+	// Lazy SMP: helper threads search private board copies and share the table
+	int threads = 1;
+	std::atomic<bool>* sharedStop = nullptr;
+
+	// Pondering: a search of the opponent's position on a board copy, filling the shared table
+	std::thread ponderThread;
+	std::atomic<bool> ponderStop{ false };
+	std::unique_ptr<Connect4> ponderBoard;
+
+	// Search budget (0 = unlimited)
+	int moveTime = 0;
+	long long nodeLimit = 0;
+	long long nodes = 0;
+	bool stopped = false;
+	bool budgetArmed = false;
+	std::atomic<bool>* stopSignal = nullptr; // Raised by the caller to end the search early
+	std::chrono::steady_clock::time_point deadline;
+
+	// Statistics of the last move; helpers only add their node counts
+	SearchStats stats;
+	std::atomic<long long> helperNodes{ 0 };
+
+	// Searches after the first must not allocate (checked in debug builds)
+	bool warmedUp = false;
+
+	MiniMax(MiniMax* main, Connect4* board);
 
 	int miniMax(int alpha, int beta);
+	void helperSearch(Connect4* board, int index, std::atomic<bool>* stop);
+	void ponderSearch();
+	bool outOfBudget();
 	std::pair<int, int> minValue(int alpha, int beta, int depth);
 	std::pair<int, int> maxValue(int alpha, int beta, int depth);
-	std::vector<int> getValidActions();
+	int getValidActions(int* actions);
+	void orderMoves(int* actions, int count, int ttMove, int depth, Actor actor);
+	void recordCutoff(int move, int depth, Actor actor, bool firstMove);
+	void resetOrdering();
 	int utility(int depth);
-	int nInARow(Actor player);
+	int scoreToTable(int score, int depth);
+	int scoreFromTable(int score, int depth);
+	bool probeTablebase(int depth, Actor toMove, int& value);
 	void generateOptimalMoveOrder();
 
 	Actor player;
@@ -30,6 +87,18 @@ public:
 	MiniMax();
 	MiniMax(Connect4* game);
 	MiniMax(Connect4* game, int depth, Actor player);
+	~MiniMax();
 
 	int getAgentMove();
+	void setTableSize(size_t megabytes);
+	void setMoveTime(int milliseconds);
+	void setNodeLimit(long long nodes);
+	void setDepth(int depth);
+	void setStopSignal(std::atomic<bool>* signal);
+	void setThreads(int threads);
+	void setOpeningBook(OpeningBook* book);
+	void setTablebase(Tablebase* tablebase);
+	bool getSearchStats(SearchStats& stats);
+	void startPondering();
+	void stopPondering();
 };
\ No newline at end of file
@@ -0,0 +1,112 @@
+// 
+// opening-book.cpp
+// Jake Buhite and Nick Abegg
+// 10/26/2023
+//
+#include "opening-book.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <unordered_set>
+#include "solver.h"
+
+static const char BOOK_MAGIC[4] = { 'C', '4', 'B', 'K' };
+static const uint32_t BOOK_VERSION = 1;
+
+bool OpeningBook::load(const std::string& fileName) {
+	header = nullptr;
+	if (!file.open(fileName)) return false;
+
+	// Validate the header and that the file holds all the entries it claims
+	const BookHeader* h = (const BookHeader*)file.data();
+	if (file.size() < sizeof(BookHeader) || std::memcmp(h->magic, BOOK_MAGIC, 4) != 0 || h->version != BOOK_VERSION
+		|| file.size() < sizeof(BookHeader) + (size_t)h->count * (sizeof(uint64_t) + sizeof(uint16_t))) {
+		std::cout << "Invalid opening book " << fileName << std::endl;
+		file.close();
+		return false;
+	}
+
+	header = h;
+	keys = (const uint64_t*)(header + 1);
+	values = (const uint16_t*)(keys + header->count);
+	std::cout << "Opening book loaded... " << header->count << " positions up to ply " << header->maxPly << std::endl;
+	return true;
+}
+
+bool OpeningBook::lookup(Connect4* board, int& move, int& score) {
+	if (header == nullptr || (int)header->rows != board->getRows() || (int)header->cols != board->getCols()) return false;
+	if (board->getRows() * board->getCols() - board->getAvailableSpaces() > (int)header->maxPly) return false;
+
+	uint64_t key = board->getKey();
+	uint64_t mirroredKey = board->getMirroredKey();
+	uint64_t canonical = std::min(key, mirroredKey);
+	const uint64_t* found = std::lower_bound(keys, keys + header->count, canonical);
+	if (found == keys + header->count || *found != canonical) return false;
+
+	uint16_t value = values[found - keys];
+	move = value >> 8;
+	score = (int8_t)(value & 0xFF);
+	if (canonical != key) move = board->getCols() - 1 - move;
+	return true;
+}
+
+int OpeningBook::getMaxPly() { return (header == nullptr) ? -1 : (int)header->maxPly; }
+
+// Solve every position reachable in up to maxPly moves, depth first on one board.
+// Children are solved before their parent so the parent's search starts from a warm table
+static void collectPositions(Connect4* board, Solver* solver, int ply, int maxPly,
+	std::unordered_set<uint64_t>& seen, std::vector<std::pair<uint64_t, uint16_t>>& entries) {
+	uint64_t key = board->getKey();
+	uint64_t canonical = std::min(key, board->getMirroredKey());
+	if (!seen.insert(canonical).second) return; // Its subtree (or its mirror's) is already done
+
+	Actor player = (ply % 2 == 0) ? PLAYER1 : PLAYER2;
+	for (int col = 0; col < board->getCols() && ply < maxPly; col++) {
+		int row = board->nextRow(col);
+		if (row == -1) continue;
+		board->addDisc(row, col, player);
+		if (board->getFourCount(player) == 0 && !board->isDraw())
+			collectPositions(board, solver, ply + 1, maxPly, seen, entries);
+		board->removeDisc(row, col);
+	}
+
+	int move = solver->getAgentMove();
+	int score = solver->getLastScore();
+	if (canonical != key) move = board->getCols() - 1 - move;
+	entries.push_back({ canonical, (uint16_t)((move << 8) | (uint8_t)(int8_t)score) });
+	if (entries.size() % 100 == 0)
+		std::cout << "Solved " << entries.size() << " positions" << std::endl;
+}
+
+bool OpeningBook::generate(const std::string& fileName, int maxPly, int rows, int cols) {
+	Connect4 board(rows, cols);
+	board.incrementRound(); // The book holds unrestricted moves; agents apply the first round rule themselves
+	Solver solver(&board);
+
+	std::unordered_set<uint64_t> seen;
+	std::vector<std::pair<uint64_t, uint16_t>> entries;
+	collectPositions(&board, &solver, 0, maxPly, seen, entries);
+	std::sort(entries.begin(), entries.end());
+
+	std::ofstream out(fileName, std::ios::out | std::ios::binary);
+	if (out.fail()) {
+		std::cout << "Could not open " << fileName << std::endl;
+		return false;
+	}
+
+	BookHeader header;
+	std::memcpy(header.magic, BOOK_MAGIC, 4);
+	header.version = BOOK_VERSION;
+	header.rows = rows;
+	header.cols = cols;
+	header.maxPly = maxPly;
+	header.count = (uint32_t)entries.size();
+	out.write((const char*)&header, sizeof(header));
+	for (std::pair<uint64_t, uint16_t>& entry : entries)
+		out.write((const char*)&entry.first, sizeof(uint64_t));
+	for (std::pair<uint64_t, uint16_t>& entry : entries)
+		out.write((const char*)&entry.second, sizeof(uint16_t));
+
+	std::cout << "Opening book saved... " << entries.size() << " positions" << std::endl;
+	return !out.fail();
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+// 
+// opening-book.h
+// Jake Buhite and Nick Abegg
+// 10/26/2023
+//
+#pragma once
+#include <string>
+#include "connect-four.h"
+#include "mapped-file.h"
+
+// Book file: header, then the sorted canonical keys, then one value per key
+// (best move << 8 | score as a signed byte, both for the canonical orientation)
+struct BookHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t rows;
+	uint32_t cols;
+	uint32_t maxPly;
+	uint32_t count;
+};
+
+// Solved opening positions, stored once per mirror pair under the smaller key
+class OpeningBook {
+private:
+	MappedFile file;
+	const BookHeader* header = nullptr;
+	const uint64_t* keys = nullptr;
+	const uint16_t* values = nullptr;
+public:
+	bool load(const std::string& fileName);
+	bool lookup(Connect4* board, int& move, int& score);
+	int getMaxPly();
+
+	static bool generate(const std::string& fileName, int maxPly, int rows, int cols);
+};
\ No newline at end of file
@@ -0,0 +1,23 @@
+// 
+// search-stats.h
+// Jake Buhite and Nick Abegg
+// 10/26/2023
+//
+#pragma once
+
+// What an agent's last move search did, for tuning depth against time
+struct SearchStats {
+	int move = -1;
+	bool bookMove = false;
+	int depthReached = 0;
+	int score = 0; // Value of the move at depthReached for the agent
+	long long nodes = 0;
+	long long helperNodes = 0; // Nodes searched by Lazy SMP helper threads
+	long long leafEvaluations = 0;
+	long long betaCutoffs = 0;
+	long long firstMoveCutoffs = 0;
+	long long tablebaseHits = 0; // Positions scored exactly by the endgame tablebase
+	double firstMoveCutoffRate = 0; // Share of cutoffs caused by the first move searched
+	double branchingFactor = 0; // Nodes of the last iteration over the one before it
+	double elapsedMs = 0;
+};
@@ -0,0 +1,200 @@
+// 
+// solver.cpp
+// Jake Buhite and Nick Abegg
+// 10/26/2023
+//
+#include "solver.h"
+#include <climits>
+#include <cstdlib>
+
+Solver::Solver(Connect4* game) : bitboard(game->getRows(), game->getCols()), table(64) {
+	this->game = game;
+	rows = game->getRows();
+	cols = game->getCols();
+
+	// Search center columns first
+	for (int i = 0; i < cols; i++)
+		columnOrder.push_back(cols / 2 + (1 - 2 * (i % 2)) * (i + 1) / 2);
+}
+
+int Solver::getAgentMove() {
+	int bookMove, bookScore;
+	if (book != nullptr && book->lookup(game, bookMove, bookScore) && !game->isDominateMove(bookMove)) {
+		lastScore = bookScore;
+		return bookMove;
+	}
+
+	BitboardPosition root = fromGame(game);
+	uint64_t next = bitboard.possible(root);
+	uint64_t wins = winningPositions(root.current, root.mask) & next;
+
+	int bestMove = -1;
+	int bestScore = INT_MIN;
+	for (int col : columnOrder) {
+		uint64_t move = next & bitboard.columnMask(col);
+		if (!move || game->isDominateMove(col)) continue;
+
+		// Take a win immediately, otherwise the best child by its exact value
+		int score = (wins & move) ? maxScore(root.moves) : -solve(bitboard.play(root, move));
+		if (score > bestScore) {
+			bestScore = score;
+			bestMove = col;
+		}
+		if (wins & move) break;
+	}
+	lastScore = bestScore;
+	return bestMove;
+}
+
+int Solver::solve() {
+	lastScore = solve(fromGame(game));
+	return lastScore;
+}
+
+int Solver::getLastScore() { return lastScore; }
+
+void Solver::setOpeningBook(OpeningBook* book) { this->book = book; }
+
+long long Solver::getNodeCount() { return nodes; }
+
+int Solver::pliesToEnd(int score) { return pliesToEnd(game, score); }
+
+int Solver::pliesToEnd(Connect4* board, int score) {
+	int rows = board->getRows();
+	int cols = board->getCols();
+	int moves = rows * cols - board->getAvailableSpaces();
+	if (score == 0) return rows * cols - moves;
+
+	// The winner ends the game with their (rows * cols / 2 + 1 - |score|)th disc
+	int winnerDisc = rows * cols / 2 + 1 - std::abs(score);
+	if (score > 0) return 2 * (winnerDisc - moves / 2) - 1;
+	return 2 * (winnerDisc - (moves + 1) / 2);
+}
+
+BitboardPosition Solver::fromGame(Connect4* board) {
+	BitboardPosition p;
+	p.moves = rows * cols - board->getAvailableSpaces();
+	p.mask = board->getMask();
+	p.current = board->getPosition((p.moves % 2 == 0) ? PLAYER1 : PLAYER2);
+	return p;
+}
+
+int Solver::solve(const BitboardPosition& p) {
+	if (canWinNext(p)) return maxScore(p.moves);
+
+	// Narrow the score window with null-window searches, trying draws first
+	int min = -(rows * cols - p.moves) / 2;
+	int max = (rows * cols + 1 - p.moves) / 2;
+	while (min < max) {
+		int med = min + (max - min) / 2;
+		if (med <= 0 && min / 2 < med) med = min / 2;
+		else if (med >= 0 && max / 2 > med) med = max / 2;
+		int r = negamax(p, med, med + 1);
+		if (r <= med) max = r;
+		else min = r;
+	}
+	return min;
+}
+
+int Solver::negamax(const BitboardPosition& p, int alpha, int beta) {
+	nodes++;
+
+	// Every move lets the opponent win next turn
+	uint64_t next = possibleNonLosingMoves(p);
+	if (next == 0) return -(rows * cols - p.moves) / 2;
+	if (p.moves >= rows * cols - 2) return 0;
+
+	// We cannot win next move, and the opponent cannot win with their next one
+	int min = minScore(p.moves + 2);
+	if (alpha < min) {
+		alpha = min;
+		if (alpha >= beta) return alpha;
+	}
+	int max = maxScore(p.moves + 2);
+	if (beta > max) {
+		beta = max;
+		if (alpha >= beta) return beta;
+	}
+
+	uint64_t key = p.current + p.mask;
+	TTEntry entry;
+	if (table.probe(key, entry)) {
+		if (entry.bound == BOUND_UPPER && beta > entry.score) {
+			beta = entry.score;
+			if (alpha >= beta) return beta;
+		}
+		else if (entry.bound == BOUND_LOWER && alpha < entry.score) {
+			alpha = entry.score;
+			if (alpha >= beta) return alpha;
+		}
+	}
+
+	// Order moves by how many winning spots they create, ties toward the center
+	uint64_t moves[64];
+	int scores[64];
+	int count = 0;
+	for (int col : columnOrder) {
+		uint64_t move = next & bitboard.columnMask(col);
+		if (!move) continue;
+		int score = Connect4::countBits(winningPositions(p.current | move, p.mask));
+		int i = count++;
+		for (; i > 0 && scores[i - 1] < score; i--) {
+			moves[i] = moves[i - 1];
+			scores[i] = scores[i - 1];
+		}
+		moves[i] = move;
+		scores[i] = score;
+	}
+
+	for (int i = 0; i < count; i++) {
+		int score = -negamax(bitboard.play(p, moves[i]), -beta, -alpha);
+		if (score >= beta) {
+			table.store(key, score, 0, BOUND_LOWER, -1);
+			return score;
+		}
+		if (score > alpha) alpha = score;
+	}
+
+	table.store(key, alpha, 0, BOUND_UPPER, -1);
+	return alpha;
+}
+
+uint64_t Solver::possibleNonLosingMoves(const BitboardPosition& p) {
+	uint64_t moves = bitboard.possible(p);
+	uint64_t opponentWins = winningPositions(p.current ^ p.mask, p.mask);
+	uint64_t forced = moves & opponentWins;
+	if (forced) {
+		// More than one forced move means we lose
+		if (forced & (forced - 1)) return 0;
+		moves = forced;
+	}
+
+	// Never play directly below a cell the opponent would win on
+	return moves & ~(opponentWins >> 1);
+}
+
+// Empty cells that would complete four in a row for `position`
+uint64_t Solver::winningPositions(uint64_t position, uint64_t mask) {
+	// Vertical
+	uint64_t r = (position << 1) & (position << 2) & (position << 3);
+
+	// Horizontal and both diagonals
+	int shifts[3] = { rows + 1, rows, rows + 2 };
+	for (int s : shifts) {
+		if (3 * s >= 64) continue;
+		uint64_t p = (position << s) & (position << (2 * s));
+		r |= p & (position << (3 * s));
+		r |= p & (position >> s);
+		p = (position >> s) & (position >> (2 * s));
+		r |= p & (position << s);
+		r |= p & (position >> (3 * s));
+	}
+
+	return r & (bitboard.getBoardMask() ^ mask);
+}
+
+bool Solver::canWinNext(const BitboardPosition& p) { return (winningPositions(p.current, p.mask) & bitboard.possible(p)) != 0; }
+
+int Solver::minScore(int moves) { return -(rows * cols - moves) / 2; }
+
+int Solver::maxScore(int moves) { return (rows * cols + 1 - moves) / 2; }
\ No newline at end of file
@@ -0,0 +1,47 @@
+// 
+// solver.h
+// Jake Buhite and Nick Abegg
+// 10/26/2023
+//
+#pragma once
+#include "agent.h"
+#include "bitboard-position.h"
+#include "connect-four.h"
+#include "opening-book.h"
+#include "transposition-table.h"
+
+// Exact solver: searches to the end of the game with a null-window negamax.
+// Scores are from the point of view of the player to move: positive if they win,
+// negative if they lose and 0 for a draw, larger the sooner the win
+// (rows * cols / 2 + 1 minus the number of discs the winner has played).
+class Solver : public Agent {
+private:
+	Connect4* game;
+	int rows;
+	int cols;
+	BitboardMoves bitboard;
+	std::vector<int> columnOrder;
+	TranspositionTable table;
+	long long nodes = 0;
+	int lastScore = 0;
+	OpeningBook* book = nullptr;
+
+	BitboardPosition fromGame(Connect4* board);
+	int solve(const BitboardPosition& p);
+	int negamax(const BitboardPosition& p, int alpha, int beta);
+	uint64_t possibleNonLosingMoves(const BitboardPosition& p);
+	uint64_t winningPositions(uint64_t position, uint64_t mask);
+	bool canWinNext(const BitboardPosition& p);
+	int minScore(int moves);
+	int maxScore(int moves);
+public:
+	Solver(Connect4* game);
+
+	int getAgentMove();
+	int solve();
+	int getLastScore();
+	long long getNodeCount();
+	int pliesToEnd(int score);
+	static int pliesToEnd(Connect4* board, int score);
+	void setOpeningBook(OpeningBook* book);
+};
\ No newline at end of file
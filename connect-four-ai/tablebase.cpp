@@ -0,0 +1,135 @@
+// 
+// tablebase.cpp
+// Jake Buhite and Nick Abegg
+// 10/26/2023
+//
+#include "tablebase.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <unordered_set>
+#include "game-record.h"
+#include "solver.h"
+
+static const char TABLEBASE_MAGIC[4] = { 'C', '4', 'T', 'B' };
+static const uint32_t TABLEBASE_VERSION = 1;
+
+bool Tablebase::load(const std::string& fileName) {
+	header = nullptr;
+	if (!file.open(fileName)) return false;
+
+	// Validate the header and that the file holds all the entries it claims
+	const TablebaseHeader* h = (const TablebaseHeader*)file.data();
+	if (file.size() < sizeof(TablebaseHeader) || std::memcmp(h->magic, TABLEBASE_MAGIC, 4) != 0
+		|| h->version != TABLEBASE_VERSION
+		|| file.size() < sizeof(TablebaseHeader) + (size_t)h->count * (sizeof(uint64_t) + sizeof(int8_t))) {
+		std::cout << "Invalid tablebase " << fileName << std::endl;
+		file.close();
+		return false;
+	}
+
+	header = h;
+	keys = (const uint64_t*)(header + 1);
+	scores = (const int8_t*)(keys + header->count);
+	std::cout << "Tablebase loaded... " << header->count << " positions with up to " << header->maxEmpty << " empty cells" << std::endl;
+	return true;
+}
+
+bool Tablebase::lookup(Connect4* board, int& score) {
+	if (header == nullptr || board->getAvailableSpaces() > (int)header->maxEmpty) return false;
+	if ((int)header->rows != board->getRows() || (int)header->cols != board->getCols()) return false;
+
+	uint64_t canonical = std::min(board->getKey(), board->getMirroredKey());
+	const uint64_t* found = std::lower_bound(keys, keys + header->count, canonical);
+	if (found == keys + header->count || *found != canonical) return false;
+
+	score = scores[found - keys];
+	return true;
+}
+
+int Tablebase::getMaxEmpty() { return (header == nullptr) ? -1 : (int)header->maxEmpty; }
+
+// Visit every unfinished position that can follow the board's, solving those with at most
+// maxEmpty empty cells. Children are solved before their parent so its search starts warm
+static void collectPositions(Connect4* board, Solver* solver, int maxEmpty,
+	std::unordered_set<uint64_t>& seen, std::vector<std::pair<uint64_t, int8_t>>& entries) {
+	uint64_t canonical = std::min(board->getKey(), board->getMirroredKey());
+	if (!seen.insert(canonical).second) return; // Its subtree (or its mirror's) is already done
+
+	int ply = board->getRows() * board->getCols() - board->getAvailableSpaces();
+	Actor player = (ply % 2 == 0) ? PLAYER1 : PLAYER2;
+	for (int col = 0; col < board->getCols(); col++) {
+		int row = board->nextRow(col);
+		if (row == -1) continue;
+		board->addDisc(row, col, player);
+		if (board->getFourCount(player) == 0 && !board->isDraw())
+			collectPositions(board, solver, maxEmpty, seen, entries);
+		board->removeDisc(row, col);
+	}
+
+	if (board->getAvailableSpaces() > maxEmpty) return;
+	entries.push_back({ canonical, (int8_t)solver->solve() });
+	if (entries.size() % 100000 == 0)
+		std::cout << "Solved " << entries.size() << " positions" << std::endl;
+}
+
+bool Tablebase::generate(const std::string& fileName, int maxEmpty, int rows, int cols, const std::string& gamesFile) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	Connect4 board(rows, cols);
+	Solver solver(&board);
+
+	std::unordered_set<uint64_t> seen;
+	std::vector<std::pair<uint64_t, int8_t>> entries;
+	if (gamesFile.empty()) collectPositions(&board, &solver, maxEmpty, seen, entries);
+	else {
+		GameRecordReader reader;
+		if (!reader.open(gamesFile)) return false;
+		if (reader.getRows() != rows || reader.getCols() != cols) {
+			std::cout << gamesFile << " holds games of another board size" << std::endl;
+			return false;
+		}
+
+		// Replay each game up to maxEmpty empty cells and take everything that can follow from there
+		GameRecord record;
+		while (reader.next(record)) {
+			board.resetBoard();
+			Actor player = PLAYER1;
+			bool finished = false;
+			for (int i = 0; i < record.count && board.getAvailableSpaces() > maxEmpty && !finished; i++) {
+				int row = board.nextRow(record.moves[i]);
+				if (row == -1) break;
+				board.addDisc(row, record.moves[i], player);
+				finished = board.getFourCount(player) > 0 || board.isDraw();
+				player = (player == PLAYER1) ? PLAYER2 : PLAYER1;
+			}
+			if (!finished && board.getAvailableSpaces() <= maxEmpty)
+				collectPositions(&board, &solver, maxEmpty, seen, entries);
+		}
+	}
+	std::sort(entries.begin(), entries.end());
+
+	std::ofstream out(fileName, std::ios::out | std::ios::binary);
+	if (out.fail()) {
+		std::cout << "Could not open " << fileName << std::endl;
+		return false;
+	}
+
+	TablebaseHeader header;
+	std::memcpy(header.magic, TABLEBASE_MAGIC, 4);
+	header.version = TABLEBASE_VERSION;
+	header.rows = rows;
+	header.cols = cols;
+	header.maxEmpty = maxEmpty;
+	header.count = (uint32_t)entries.size();
+	out.write((const char*)&header, sizeof(header));
+	for (std::pair<uint64_t, int8_t>& entry : entries)
+		out.write((const char*)&entry.first, sizeof(uint64_t));
+	for (std::pair<uint64_t, int8_t>& entry : entries)
+		out.write((const char*)&entry.second, sizeof(int8_t));
+
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "Tablebase saved... " << entries.size() << " positions, "
+		<< (sizeof(header) + entries.size() * 9) / 1024 << " KB in " << elapsed << " s" << std::endl;
+	return !out.fail();
+}
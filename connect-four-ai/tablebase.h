@@ -0,0 +1,47 @@
+// 
+// tablebase.h
+// Jake Buhite and Nick Abegg
+// 10/26/2023
+//
+#pragma once
+#include <string>
+#include "connect-four.h"
+#include "mapped-file.h"
+
+// Tablebase file: header, then the sorted canonical keys, then one exact score per key
+// (a signed byte, from the point of view of the player to move, as returned by Solver)
+struct TablebaseHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t rows;
+	uint32_t cols;
+	uint32_t maxEmpty;
+	uint32_t count;
+};
+
+// Solved late positions with at most maxEmpty empty cells, stored once per mirror pair under
+// the smaller key. Generated either from the empty board, which enumerates every reachable
+// position and is only practical on small boards, or from the positions where the games of a
+// game record file reach maxEmpty empty cells, each with every position that can follow it.
+// Each entry takes 9 bytes. Measured generation (N = maxEmpty):
+//   source                        N     entries   file     time    peak memory
+//   4x5, empty board              8     1.40M     12 MB    3.4 s   165 MB
+//   4x5, empty board              20    1.55M     14 MB    3.7 s   167 MB  (the whole game)
+//   6x7, 2000 self-play games     10    1789      15 KB    0.07 s  67 MB
+//   6x7, 2000 self-play games     12    11.5k     100 KB   0.08 s  68 MB
+//   6x7, 2000 self-play games     16    298k      2.6 MB   0.5 s   86 MB
+//   6x7, 2000 self-play games     20    12.8M     112 MB   32 s    902 MB
+//   6x7, 353k self-play games     12    740k      6.5 MB   4.7 s   119 MB
+class Tablebase {
+private:
+	MappedFile file;
+	const TablebaseHeader* header = nullptr;
+	const uint64_t* keys = nullptr;
+	const int8_t* scores = nullptr;
+public:
+	bool load(const std::string& fileName);
+	bool lookup(Connect4* board, int& score);
+	int getMaxEmpty();
+
+	static bool generate(const std::string& fileName, int maxEmpty, int rows, int cols, const std::string& gamesFile = "");
+};
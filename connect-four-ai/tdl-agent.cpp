@@ -1,5 +1,81 @@
 #include "tdl-agent.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <fstream>
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define TDL_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define AVX2_TARGET
+#else
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+#ifdef TDL_X86
+// AVX2 needs support from both the CPU and the OS (saved YMM state)
+static bool hasAVX2() {
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) return false;
+	__cpuid(info, 1);
+	if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6) return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+static const bool useAVX2 = hasAVX2();
+
+AVX2_TARGET static double sumFloat64AVX2(const double* values, const int* indices, int count) {
+	// The masked gather with an explicit source is the same instruction as _mm256_i32gather_pd,
+	// whose GCC definition reads an uninitialised source and trips -Wmaybe-uninitialized
+	const __m256d zero = _mm256_setzero_pd();
+	const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+	__m256d sum = zero;
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i index = _mm_loadu_si128((const __m128i*)(indices + i));
+		sum = _mm256_add_pd(sum, _mm256_mask_i32gather_pd(zero, values, index, all, 8));
+	}
+	double lanes[4];
+	_mm256_storeu_pd(lanes, sum);
+	double total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+	for (; i < count; i++)
+		total += values[indices[i]];
+	return total;
+}
+
+// Gathers the 32 bits ending at each int16 weight and keeps the top half. The file header
+// precedes the mapped weights, so the two bytes before index 0 are always readable.
+// Each tuple holds 65536 weights, so the tuple of an index is index >> 16
+AVX2_TARGET static double sumInt16AVX2(const int16_t* values, const float* scales, const int* indices, int count) {
+	const int* base = (const int*)((const char*)values - 2);
+	__m256d sum = _mm256_setzero_pd();
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i index = _mm256_loadu_si256((const __m256i*)(indices + i));
+		__m256i weight = _mm256_srai_epi32(_mm256_i32gather_epi32(base, index, 2), 16);
+		__m256 scale = _mm256_i32gather_ps(scales, _mm256_srli_epi32(index, 16), 4);
+		sum = _mm256_add_pd(sum, _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(weight)),
+			_mm256_cvtps_pd(_mm256_castps256_ps128(scale))));
+		sum = _mm256_add_pd(sum, _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(weight, 1)),
+			_mm256_cvtps_pd(_mm256_extractf128_ps(scale, 1))));
+	}
+	double lanes[4];
+	_mm256_storeu_pd(lanes, sum);
+	double total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+	for (; i < count; i++)
+		total += values[indices[i]] * (double)scales[indices[i] >> 16];
+	return total;
+}
+#endif
 
 TDLAgent::TDLAgent(bool training, int player, double alphaInit, double epsilonInit) {
 	this->training = training;
@@ -9,50 +85,111 @@ TDLAgent::TDLAgent(bool training, int player, double alphaInit, double epsilonIn
 	this->alpha = alphaInit;
 	this->epsilon = epsilonInit;
 
-	weights = new double[numWeights];
-	for (int i = 0; i < numWeights; i++) {
-		weights[i] = 0;
-	}
+	random.seed(rand());
+	traces.reserve(TDL_MAX_TRACES);
 
 	game = new Connect4();
+	initIndexTables();
+	getIndices(game, indices);
 }
 
-std::vector<int> TDLAgent::getIndices(int** state1, int** state2) {
-	std::vector<int> indices(numTuples * 2);
-	int curIndex = 0;
+TDLAgent::~TDLAgent() {
+	delete game;
+	if (ownsWeights) delete[] weights;
+}
 
+void TDLAgent::initIndexTables() {
+	std::vector<std::vector<std::pair<int, int>>> entries(42);
 	for (int i = 0; i < numTuples; i++) {
-		int* tuple = nTuples[i];
-		int i1 = 65536 * i; // Weights per tuple = 65536
-		int i2 = 65536 * i;
-
-		for (int j = 0; i < tupleLength; i++) {
-			int col = (41 - tuple[j]) % 7;
-			int row = (41 - tuple[j]) / 7;
-			// determine what the value of that board space is in both states
-			if (state1[row][col] != 0) {
-				i1 += (int) (pow(4, j) * state1[row][col]);
-			}
-			else if (5 - game->nextRow(col) == row) {
-				i1 += (int) (3 * pow(4, j));
-			}
-
-			if (state2[row][col] != 0) {
-				i2 += (int) (pow(4, j) * state2[row][col]);
-			}
-			else if (5 - game->nextRow(6 - col) == row) {
-				i2 += (int) (3 * pow(4, j));
-			}
+		int power = 1;
+		for (int j = 0; j < tupleLength; j++) {
+			int col = (41 - nTuples[i][j]) % 7;
+			int height = (41 - nTuples[i][j]) / 7;
+			entries[height * 7 + col].push_back({ 2 * i, power });
+			entries[height * 7 + 6 - col].push_back({ 2 * i + 1, power });
+			power *= 4;
+		}
+	}
+
+	cellEntryStart[0] = 0;
+	for (int cell = 0; cell < 42; cell++) {
+		for (std::pair<int, int>& entry : entries[cell]) {
+			cellEntrySlot.push_back(entry.first);
+			cellEntryPower.push_back(entry.second);
+		}
+		cellEntryStart[cell + 1] = (int)cellEntrySlot.size();
+	}
+}
+
+void TDLAgent::getIndices(Connect4* state, int* result) {
+	for (int i = 0; i < numTuples; i++) {
+		result[2 * i] = weightsPerTuple * i;
+		result[2 * i + 1] = weightsPerTuple * i;
+	}
+
+	// Each cell counts as its disc (1 or 2), 3 when it is the next playable cell, else 0
+	for (int col = 0; col < 7; col++) {
+		int nextHeight = 5 - state->nextRow(col);
+		for (int height = 0; height < 6; height++) {
+			int value = state->getCell(5 - height, col);
+			if (value == 0 && height == nextHeight) value = 3;
+			if (value == 0) continue;
+			int cell = height * 7 + col;
+			for (int k = cellEntryStart[cell]; k < cellEntryStart[cell + 1]; k++)
+				result[cellEntrySlot[k]] += value * cellEntryPower[k];
 		}
-		indices[curIndex] = i1;
-		indices[curIndex + 1] = i2;
-		curIndex += 2;
 	}
-	return indices;
 }
 
-void TDLAgent::computeAlpha() {
-	games += 1;
+// Actor's disc at (row, col) of a position whose indices are in out: only the tuples through that
+// cell and the cell above it, which becomes the next playable one, change
+void TDLAgent::patchIndices(int row, int col, Actor actor, int* out) {
+	int cell = (5 - row) * 7 + col;
+	for (int k = cellEntryStart[cell]; k < cellEntryStart[cell + 1]; k++)
+		out[cellEntrySlot[k]] += (actor - 3) * cellEntryPower[k];
+	if (row == 0) return;
+	cell += 7;
+	for (int k = cellEntryStart[cell]; k < cellEntryStart[cell + 1]; k++)
+		out[cellEntrySlot[k]] += 3 * cellEntryPower[k];
+}
+
+// Moves game to board. The discs played since the last call, usually our move and the reply, are
+// patched in from the bottom of each column; any other change rebuilds the indices
+void TDLAgent::updateIndices(Connect4* board) {
+	uint64_t added[3];
+	bool extends = true;
+	for (int actor = PLAYER1; actor <= PLAYER2; actor++) {
+		added[actor] = board->getPosition((Actor)actor) & ~game->getPosition((Actor)actor);
+		extends = extends && (game->getPosition((Actor)actor) & ~board->getPosition((Actor)actor)) == 0;
+	}
+	game->setBoard(board);
+	if (!extends) {
+		getIndices(game, indices);
+		return;
+	}
+
+	// Bit col * 7 + height from the bottom
+	uint64_t discs = added[PLAYER1] | added[PLAYER2];
+	for (int col = 0; col < 7 && discs != 0; col++) {
+		if (((discs >> (col * 7)) & 0x3F) == 0) continue;
+		for (int height = 0; height < 6; height++) {
+			uint64_t bit = 1ULL << (col * 7 + height);
+			if (discs & bit) patchIndices(5 - height, col, (added[PLAYER1] & bit) ? PLAYER1 : PLAYER2, indices);
+		}
+	}
+}
+
+// Indices after actor plays (row, col)
+void TDLAgent::afterstateIndices(int row, int col, Actor actor, int* out) {
+	std::memcpy(out, indices, sizeof(int) * TDL_NUM_INDICES);
+	patchIndices(row, col, actor, out);
+}
+
+void TDLAgent::computeAlpha() { computeAlpha(games + 1); }
+
+// Step sizes for the given number of games played, which parallel trainers take from a shared counter
+void TDLAgent::computeAlpha(int gamesPlayed) {
+	games = gamesPlayed;
 	alpha = 0.001 + (initialAlpha - 0.001) * exp(-0.000005 * games);
 	epsilon = 0.1 + (initialEpsilon - 0.1) * exp(-0.000005 * games);
 }
@@ -60,85 +197,79 @@ void TDLAgent::computeAlpha() {
 int TDLAgent::updateWeights(int bestMove, double bestMoveValue) {
 	double curValue = 0;
 
-	// Get the indices array for the current board state
-	int** boardState = game->getBoard();
-	int** mirroredState = game->getMirroredField(boardState);
-	std::vector<int> indices = getIndices(boardState, mirroredState);
-
 	// get the value for the current board state
-	for (int i = 0; i < indices.size(); i++) {
+	makeWeightsWritable();
+	for (int i = 0; i < TDL_NUM_INDICES; i++) {
 		curValue += weights[indices[i]];
 	}
 	curValue = tanh(curValue);
 
+	// Decay the traces, dropping the ones too small to matter and, if still full, the oldest
+	int kept = 0;
+	for (std::pair<int, double>& trace : traces) {
+		trace.second *= lambda;
+		if (trace.second >= TDL_TRACE_THRESHOLD) traces[kept++] = trace;
+	}
+	traces.resize(kept);
+	if (traces.size() + TDL_NUM_INDICES > TDL_MAX_TRACES)
+		traces.erase(traces.begin(), traces.begin() + (traces.size() + TDL_NUM_INDICES - TDL_MAX_TRACES));
+
+	// The current state's weights become fully eligible, with the gradient of tanh
+	double gradient = 1.0 - pow(curValue, 2);
+	for (int i = 0; i < TDL_NUM_INDICES; i++) {
+		traces.push_back({ indices[i], gradient });
+	}
+
 	// Update weight array
 	double delta_t = bestMoveValue - curValue;
-	double change = alpha * delta_t * (1.0 - pow(curValue, 2));
+	double step = alpha * delta_t;
 
-	for (int i = 0; i < indices.size(); i++) {
-		weights[indices[i]] += change;
+	for (std::pair<int, double>& trace : traces) {
+		weights[trace.first] += step * trace.second;
 	}
 
-	// Deallocate mirroredState
-	for (int i = 0; i < game->getRows(); i++)
-		delete[] mirroredState[i];
-	delete[] mirroredState;
-
 	return bestMove;
 }
 
-int TDLAgent::getBestMove(int** board) {
-	game->setBoard(board);
-	std::vector<int> possibleMoves = game->generateTDLMoves(player);
+int TDLAgent::getBestMove(Connect4* board) {
+	updateIndices(board);
+	int possibleMoves[TDL_MAX_MOVES];
+	int count = game->generateTDLMoves(possibleMoves);
 
 	if (training) {
-		double e = static_cast<double>(rand()) / RAND_MAX;
+		double e = std::uniform_real_distribution<double>(0, 1)(random);
 		// take random move
 		if (e < epsilon) {
-			int randomMove = rand() % possibleMoves.size();
+			int randomMove = random() % count;
 			return possibleMoves[randomMove];
 		}
 	}
 
-	double bestValue = -100;
-	int bestIndex = -1;
-
-	for (int i = 0; i < possibleMoves.size(); i++) {
-		// calculate vector x for each move
-		double value = 0;
-
-		if (game->canWin(player, possibleMoves[i], game->nextRow(possibleMoves[i]))) {
-			value = 1;
-		}
-
+	// Build the index vectors of every candidate afterstate first, so the table lookups of all
+	// candidates are independent loads that can overlap instead of waiting on each move in turn
+	int afterstates[TDL_MAX_MOVES][TDL_NUM_INDICES];
+	double moveValues[TDL_MAX_MOVES];
+	bool lookup[TDL_MAX_MOVES];
+	for (int i = 0; i < count; i++) {
 		int row = game->nextRow(possibleMoves[i]);
+		moveValues[i] = game->canWin(player, possibleMoves[i], row) ? 1 : 0;
+		lookup[i] = moveValues[i] == 0 && game->getAvailableSpaces() > 1 && !exactValue(row, possibleMoves[i], moveValues[i]);
+		if (lookup[i])
+			afterstateIndices(row, possibleMoves[i], player, afterstates[i]);
+	}
 
-		game->addDisc(row, possibleMoves[i], player);
-
-		if (value == 0 && !game->isDraw()) {
-			// start using this part
-			int** boardState = game->getBoard();
-			int** mirroredState = game->getMirroredField(boardState);
-			std::vector<int> indices = getIndices(boardState, mirroredState);
-
-			// calculate dot product for each
-			for (int j = 0; j < indices.size(); j++) {
-				value -= other->weights[indices[j]];
-			}
-			value = tanh(value);
+	double bestValue = -100;
+	int bestIndex = -1;
 
-			// Deallocate mirroredState
-			for (int i = 0; i < game->getRows(); i++)
-				delete[] mirroredState[i];
-			delete[] mirroredState;
-		}
+	for (int i = 0; i < count; i++) {
+		// calculate dot product for each
+		if (lookup[i])
+			moveValues[i] = tanh(-other->sumWeights(afterstates[i], TDL_NUM_INDICES));
 
-		if (value > bestValue) {
-			bestValue = value;
+		if (moveValues[i] > bestValue) {
+			bestValue = moveValues[i];
 			bestIndex = i;
 		}
-
-		game->removeDisc(row, possibleMoves[i]);
 	}
 
 	// last best value
@@ -152,6 +283,30 @@ int TDLAgent::getBestMove(int** board) {
 }
 
 void TDLAgent::loadAgent(std::string fileName) {
+	// A missing binary file is converted from the text weights of the same name on first use
+	std::string textFile = textWeightsFile(fileName);
+	if (!std::ifstream(fileName).good() && !textFile.empty() && std::ifstream(textFile).good()) {
+		std::cout << "Converting " << textFile << " to " << fileName << std::endl;
+		convertWeights(textFile, fileName);
+	}
+
+	// Binary weight files are mapped and used in place
+	if (WeightFile::isWeightFile(fileName)) {
+		if (!weightFile.load(fileName)) exit(1);
+		const WeightHeader* header = weightFile.getHeader();
+		if (header->numTuples != (uint32_t)numTuples || header->tupleLength != (uint32_t)tupleLength
+			|| header->weightsPerTuple != (uint32_t)weightsPerTuple) {
+			std::cout << "Weight file " << fileName << " does not match this agent's tuples" << std::endl;
+			exit(1);
+		}
+		valueType = (WeightType)header->type;
+		values = weightFile.getData();
+		scales = weightFile.getScales();
+		if (training) makeWeightsWritable();
+		std::cout << "Weights successfully mapped... Length " << header->count << std::endl;
+		return;
+	}
+
 	std::ifstream inputFile;
 	double num = -1;
 
@@ -159,11 +314,14 @@ void TDLAgent::loadAgent(std::string fileName) {
 	inputFile.open(fileName, std::ios::in);
 	if (inputFile.fail())
 	{
-		std::cout << "Could not open weights.txt" << std::endl;
+		std::cout << "Could not open " << fileName << std::endl;
 		exit(1);
 	}
 
 	// Add weights
+	valueType = WEIGHT_FLOAT64;
+	values = nullptr;
+	makeWeightsWritable();
 	inputFile >> num;
 	int i = 0;
 	while (!inputFile.fail() && i < numWeights)
@@ -181,22 +339,156 @@ void TDLAgent::loadAgent(std::string fileName) {
 }
 
 void TDLAgent::saveAgent(std::string fileName) {
-	double num = -1;
-	std::ofstream outputFile;
-
-	outputFile.open(fileName, std::ios::out);
-	if (outputFile.fail())
-	{
-		std::cout << "Open of weights.txt failed" << std::endl;
+	makeWeightsWritable();
+	if (!WeightFile::save(fileName, numTuples, tupleLength, weightsPerTuple, WEIGHT_FLOAT64, weights, numWeights))
 		exit(1);
+
+	std::cout << "Weights successfully saved..." << std::endl;
+}
+
+// Training writes to the weights, so expand a mapped or quantized file into the agent's own array first
+void TDLAgent::makeWeightsWritable() {
+	if (weights != nullptr && values == weights) return;
+	if (!ownsWeights) {
+		weights = new double[numWeights];
+		ownsWeights = true;
 	}
 
 	for (int i = 0; i < numWeights; i++) {
-		outputFile << weights[i] << std::endl;
+		switch (valueType) {
+		case WEIGHT_INT16:
+			weights[i] = ((const int16_t*)values)[i] * (double)scales[i / weightsPerTuple];
+			break;
+		case WEIGHT_FLOAT16:
+			weights[i] = halfToFloat(((const uint16_t*)values)[i]);
+			break;
+		default:
+			weights[i] = (values == nullptr) ? 0 : ((const double*)values)[i];
+		}
+	}
+	valueType = WEIGHT_FLOAT64;
+	values = weights;
+	scales = nullptr;
+}
+
+// Use source's weight table in place of this agent's own. Hogwild training shares one writable
+// table between the agents of every worker, whose updates then race without locks; a lost
+// update only drops one small step
+void TDLAgent::shareWeights(TDLAgent* source) {
+	if (source->training) source->makeWeightsWritable();
+	if (ownsWeights) delete[] weights;
+	ownsWeights = false;
+	weights = source->weights;
+	valueType = source->valueType;
+	values = source->values;
+	scales = source->scales;
+}
+
+void TDLAgent::setSeed(unsigned int seed) { random.seed(seed); }
+
+void TDLAgent::setLambda(double lambda) { this->lambda = lambda; }
+
+void TDLAgent::setTablebase(Tablebase* tablebase) { this->tablebase = tablebase; }
+
+// Game-theoretic value of state for the player to move when it is in the tablebase:
+// 1 for a win, 0 for a draw and -1 for a loss, in place of the table's estimate
+bool TDLAgent::exactValue(Connect4* state, double& value) {
+	int score;
+	if (tablebase == nullptr || !tablebase->lookup(state, score)) return false;
+	value = (score > 0) ? 1 : (score < 0) ? -1 : 0;
+	return true;
+}
+
+// Exact value of playing (row, col), for this agent
+bool TDLAgent::exactValue(int row, int col, double& value) {
+	if (tablebase == nullptr || game->getAvailableSpaces() - 1 > tablebase->getMaxEmpty()) return false;
+	game->addDisc(row, col, player);
+	bool found = exactValue(game, value);
+	game->removeDisc(row, col);
+	if (found) value = -value;
+	return found;
+}
+
+// Traces only link states of the same game, so clear them before each one
+void TDLAgent::resetTraces() { traces.clear(); }
+
+// Sum of the weights at the given indices, in whichever form the agent holds them
+double TDLAgent::sumWeights(const int* indices, int count) {
+	double sum = 0;
+	switch (valueType) {
+	case WEIGHT_INT16:
+#ifdef TDL_X86
+		if (useAVX2 && weightsPerTuple == 65536)
+			return sumInt16AVX2((const int16_t*)values, scales, indices, count);
+#endif
+		for (int i = 0; i < count; i++)
+			sum += ((const int16_t*)values)[indices[i]] * (double)scales[indices[i] / weightsPerTuple];
+		break;
+	case WEIGHT_FLOAT16:
+		for (int i = 0; i < count; i++)
+			sum += halfToFloat(((const uint16_t*)values)[indices[i]]);
+		break;
+	default:
+		if (values == nullptr) break; // Untrained agent, every weight is zero
+#ifdef TDL_X86
+		if (useAVX2)
+			return sumFloat64AVX2((const double*)values, indices, count);
+#endif
+		for (int i = 0; i < count; i++)
+			sum += ((const double*)values)[indices[i]];
 	}
+	return sum;
+}
 
-	std::cout << "Weights successfully saved..." << std::endl;
-	outputFile.close();
+// Text weights that stand in for a missing binary file: weights1.txt for weights1.bin
+std::string TDLAgent::textWeightsFile(std::string binaryFile) {
+	if (binaryFile.size() < 4 || binaryFile.compare(binaryFile.size() - 4, 4, ".bin") != 0) return "";
+	return binaryFile.substr(0, binaryFile.size() - 4) + ".txt";
+}
+
+bool TDLAgent::weightsExist(std::string fileName) {
+	std::string textFile = textWeightsFile(fileName);
+	return std::ifstream(fileName).good() || (!textFile.empty() && std::ifstream(textFile).good());
+}
+
+// One-shot conversion of a text weight file (one weight per line) to the binary format
+bool TDLAgent::convertWeights(std::string textFile, std::string binaryFile) {
+	TDLAgent agent(false, PLAYER1, 0, 0);
+	agent.loadAgent(textFile);
+	agent.saveAgent(binaryFile);
+	return true;
+}
+
+// Inference-only copy of trained weights as float16, or int16 scaled by each tuple's largest weight
+bool TDLAgent::quantizeWeights(std::string inputFile, std::string outputFile, WeightType type) {
+	TDLAgent agent(false, PLAYER1, 0, 0);
+	agent.loadAgent(inputFile);
+	agent.makeWeightsWritable();
+
+	std::vector<uint16_t> quantized(agent.numWeights);
+	std::vector<float> tupleScales(agent.numTuples, 0);
+	for (int t = 0; t < agent.numTuples; t++) {
+		double* tupleWeights = agent.weights + (size_t)t * agent.weightsPerTuple;
+		if (type == WEIGHT_INT16) {
+			double largest = 0;
+			for (int i = 0; i < agent.weightsPerTuple; i++)
+				largest = std::max(largest, std::fabs(tupleWeights[i]));
+			tupleScales[t] = (largest == 0) ? 1.0f : (float)(largest / 32767);
+		}
+		for (int i = 0; i < agent.weightsPerTuple; i++) {
+			uint16_t& out = quantized[(size_t)t * agent.weightsPerTuple + i];
+			if (type == WEIGHT_INT16)
+				out = (uint16_t)(int16_t)std::max(-32767.0, std::min(32767.0, std::round(tupleWeights[i] / tupleScales[t])));
+			else
+				out = floatToHalf((float)tupleWeights[i]);
+		}
+	}
+
+	if (!WeightFile::save(outputFile, agent.numTuples, agent.tupleLength, agent.weightsPerTuple, type, quantized.data(),
+		agent.numWeights, tupleScales.data()))
+		return false;
+	std::cout << "Weights successfully quantized..." << std::endl;
+	return true;
 }
 
 double TDLAgent::getAlpha() { return alpha; }
@@ -1,5 +1,14 @@
+#pragma once
 #include "minimax.h"
+#include "tablebase.h"
+#include "weight-file.h"
 #include <fstream>
+#include <random>
+
+constexpr auto TDL_MAX_MOVES = 7; // One move per column of the 6x7 board
+constexpr auto TDL_NUM_INDICES = 136; // Two indices (normal and mirrored) per tuple
+constexpr auto TDL_TRACE_THRESHOLD = 0.01; // Eligibility traces below this are dropped
+constexpr auto TDL_MAX_TRACES = TDL_NUM_INDICES * 32;
 
 class TDLAgent {
 private:
@@ -81,7 +90,15 @@ private:
 	};
 
 	int numWeights = 4456448;
-	double* weights;
+	int weightsPerTuple = 65536;
+	double* weights = nullptr; // Writable weights, allocated when first needed
+	bool ownsWeights = false; // False while weights belong to the agent they are shared from
+
+	// Weights read during play: either the array above or a mapped weight file, stored as valueType
+	WeightType valueType = WEIGHT_FLOAT64;
+	const void* values = nullptr;
+	const float* scales = nullptr;
+	WeightFile weightFile;
 
 	Actor player;
 	bool training;
@@ -89,16 +106,53 @@ private:
 	double alpha;
 	int lastBestValue = 0;
 	TDLAgent* other;
+	std::mt19937 random; // Per agent, so training threads don't share the C runtime's generator
+
+	// TD(lambda): decayed eligibility of recently visited weights, oldest first. Lambda 0 is TD(0)
+	double lambda = 0;
+	std::vector<std::pair<int, double>> traces;
 
 	Connect4* game;
+	Tablebase* tablebase = nullptr;
+
+	// For each cell (numbered height * 7 + col from the bottom left), the index slots whose tuples
+	// contain it and the power of 4 of its position there. Mirrored tuples use slot 2 * tuple + 1
+	int cellEntryStart[43];
+	std::vector<int> cellEntrySlot;
+	std::vector<int> cellEntryPower;
+
+	// Indices of game's current position, patched into each candidate afterstate
+	int indices[TDL_NUM_INDICES];
+
+	void initIndexTables();
+	void patchIndices(int row, int col, Actor actor, int* out);
+	void updateIndices(Connect4* board);
+	void afterstateIndices(int row, int col, Actor actor, int* out);
+	bool exactValue(int row, int col, double& value);
 public:
     TDLAgent(bool isTraining, int player, double alphaInit, double epsilonInit);
-	std::vector<int> getIndices(int** state1, int** state2);
+	TDLAgent(const TDLAgent&) = delete;
+	TDLAgent& operator=(const TDLAgent&) = delete;
+	~TDLAgent();
+	void getIndices(Connect4* state, int* out);
 	void computeAlpha();
+	void computeAlpha(int gamesPlayed);
 	int updateWeights(int bestMove, double bestMoveValue);
-	int getBestMove(int** board);
+	double sumWeights(const int* indices, int count);
+	int getBestMove(Connect4* board);
 	void loadAgent(std::string fileName);
 	void saveAgent(std::string fileName);
+	void makeWeightsWritable();
+	void shareWeights(TDLAgent* source);
+	void setSeed(unsigned int seed);
+	void setLambda(double lambda);
+	void setTablebase(Tablebase* tablebase);
+	bool exactValue(Connect4* state, double& value);
+	void resetTraces();
+	static bool convertWeights(std::string textFile, std::string binaryFile);
+	static std::string textWeightsFile(std::string binaryFile);
+	static bool weightsExist(std::string fileName);
+	static bool quantizeWeights(std::string inputFile, std::string outputFile, WeightType type);
 
 	double getAlpha();
 	double getEpsilon();
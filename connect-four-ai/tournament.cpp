@@ -0,0 +1,298 @@
+// 
+// tournament.cpp
+// Jake Buhite and Nick Abegg
+// 10/26/2023
+//
+#include "tournament.h"
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <thread>
+#include "mcts.h"
+#include "minimax.h"
+#include "solver.h"
+
+// A TDLAgent seen as an Agent: it values each afterstate with the opponent's table
+class TDLPlayer : public Agent {
+private:
+	Connect4* game;
+	TDLAgent own;
+	TDLAgent opponent;
+public:
+	TDLPlayer(Connect4* game, Actor actor, std::unique_ptr<TDLAgent>* tables, Tablebase* tablebase)
+		: game(game), own(false, actor, 0, 0), opponent(false, (actor == PLAYER1) ? PLAYER2 : PLAYER1, 0, 0) {
+		Actor other = (actor == PLAYER1) ? PLAYER2 : PLAYER1;
+		own.shareWeights(tables[actor].get());
+		opponent.shareWeights(tables[other].get());
+		own.setOther(&opponent);
+		own.setTablebase(tablebase);
+	}
+
+	int getAgentMove() { return own.getBestMove(game); }
+};
+
+Tournament::Tournament(int rows, int cols) {
+	this->rows = rows;
+	this->cols = cols;
+}
+
+bool Tournament::addEntrant(const std::string& spec) {
+	std::vector<std::string> fields;
+	std::stringstream stream(spec);
+	std::string field;
+	while (std::getline(stream, field, ':'))
+		fields.push_back(field);
+
+	Entrant entrant;
+	entrant.spec = spec;
+	entrant.kind = fields.empty() ? "" : fields[0];
+	if ((entrant.kind == "minimax" || entrant.kind == "mcts") && fields.size() == 2) {
+		entrant.strength = std::atoi(fields[1].c_str());
+		if (entrant.strength <= 0) entrant.kind = "";
+	}
+	else if (entrant.kind == "tdl" && fields.size() == 3 && rows == 6 && cols == 7) {
+		// Loaded once here; the agents of every thread read them through shareWeights
+		for (int actor = PLAYER1; actor <= PLAYER2; actor++) {
+			entrant.tables[actor].reset(new TDLAgent(false, actor, 0, 0));
+			entrant.tables[actor]->loadAgent(fields[actor]);
+		}
+	}
+	else if (entrant.kind != "solver" || fields.size() != 1) entrant.kind = "";
+
+	if (entrant.kind.empty()) {
+		std::cout << "Unknown agent " << spec << " (expected minimax:<depth>, mcts:<iterations>, solver or tdl:<weights1>:<weights2> on 6x7)" << std::endl;
+		return false;
+	}
+	entrants.push_back(std::move(entrant));
+	return true;
+}
+
+void Tournament::setSeed(unsigned int seed) { this->seed = seed; }
+
+// Endgame tablebase of the MiniMax and TDL entrants
+void Tournament::setTablebase(Tablebase* tablebase) { this->tablebase = tablebase; }
+
+void Tournament::run(int gamesPerPairing, int threads) {
+	// Each opening is played twice per pairing, once with either agent moving first
+	int n = (int)entrants.size();
+	schedule.clear();
+	for (int i = 0; i < n; i++) {
+		for (int j = i + 1; j < n; j++) {
+			for (int k = 0; k < (gamesPerPairing + 1) / 2; k++) {
+				unsigned int opening = seed + (unsigned int)schedule.size();
+				schedule.push_back({ { -1, i, j }, opening });
+				schedule.push_back({ { -1, j, i }, opening });
+			}
+		}
+	}
+
+	total.wins.assign(n, std::vector<int>(n, 0));
+	total.draws.assign(n, std::vector<int>(n, 0));
+	total.moveMs.assign(n, 0);
+	total.moves.assign(n, 0);
+	nextGame = 0;
+
+	threads = std::max(1, threads);
+	std::vector<Tally> tallies(threads);
+	std::vector<std::thread> workers;
+	for (int i = 0; i < threads; i++)
+		workers.push_back(std::thread(&Tournament::worker, this, i, &tallies[i]));
+	for (std::thread& worker : workers)
+		worker.join();
+
+	for (Tally& tally : tallies) {
+		for (int i = 0; i < n; i++) {
+			for (int j = 0; j < n; j++) {
+				total.wins[i][j] += tally.wins[i][j];
+				total.draws[i][j] += tally.draws[i][j];
+			}
+			total.moveMs[i] += tally.moveMs[i];
+			total.moves[i] += tally.moves[i];
+		}
+	}
+}
+
+// Plays scheduled games until none are left, on one board with agents created on first use
+void Tournament::worker(int index, Tally* tally) {
+	int n = (int)entrants.size();
+	tally->wins.assign(n, std::vector<int>(n, 0));
+	tally->draws.assign(n, std::vector<int>(n, 0));
+	tally->moveMs.assign(n, 0);
+	tally->moves.assign(n, 0);
+
+	Connect4 board(rows, cols);
+	std::vector<std::unique_ptr<Agent>> agents(3 * n);
+	int completed = 0;
+	for (int i = nextGame.fetch_add(1); i < (int)schedule.size(); i = nextGame.fetch_add(1)) {
+		const Game& game = schedule[i];
+		Agent* players[3] = { nullptr, nullptr, nullptr };
+		for (int actor = PLAYER1; actor <= PLAYER2; actor++) {
+			std::unique_ptr<Agent>& agent = agents[3 * game.entrant[actor] + actor];
+			if (!agent) agent.reset(createAgent(game.entrant[actor], &board, (Actor)actor, index));
+			players[actor] = agent.get();
+		}
+
+		Actor winner = playGame(&board, game, players, tally);
+		if (winner == NONE) {
+			tally->draws[game.entrant[PLAYER1]][game.entrant[PLAYER2]]++;
+			tally->draws[game.entrant[PLAYER2]][game.entrant[PLAYER1]]++;
+		}
+		else {
+			Actor loser = (winner == PLAYER1) ? PLAYER2 : PLAYER1;
+			tally->wins[game.entrant[winner]][game.entrant[loser]]++;
+		}
+		if (++completed % 10 == 0)
+			std::cout << "Thread " + std::to_string(index) + " finished " + std::to_string(completed) + " games\n";
+	}
+}
+
+Agent* Tournament::createAgent(int entrant, Connect4* board, Actor actor, int index) {
+	Entrant& e = entrants[entrant];
+	if (e.kind == "minimax") {
+		MiniMax* agent = new MiniMax(board, e.strength, actor);
+		agent->setTableSize(TOURNAMENT_TABLE_MB);
+		agent->setTablebase(tablebase);
+		return agent;
+	}
+	if (e.kind == "mcts") {
+		MCTS* agent = new MCTS(board, actor);
+		agent->setIterationLimit(e.strength);
+		agent->setSeed(seed + 1000 * index + actor);
+		return agent;
+	}
+	if (e.kind == "tdl") return new TDLPlayer(board, actor, e.tables, tablebase);
+	return new Solver(board);
+}
+
+// Plays one game from a random opening and returns the winner (NONE for a draw). An agent
+// that returns an illegal move loses the game
+Actor Tournament::playGame(Connect4* board, const Game& game, Agent* agents[3], Tally* tally) {
+	board->resetBoard();
+	playOpening(board, game.opening);
+
+	while (!board->hasWinner() && !board->isDraw()) {
+		Actor actor = (board->getCurrentTurn() == PLAYER1) ? PLAYER2 : PLAYER1;
+		board->setCurrentTurn(actor);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		int move = agents[actor]->getAgentMove();
+		tally->moveMs[game.entrant[actor]] += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		tally->moves[game.entrant[actor]]++;
+
+		int row = board->nextRow(move);
+		if (row == -1 || board->isDominateMove(move)) return (actor == PLAYER1) ? PLAYER2 : PLAYER1;
+		board->addDisc(row, move);
+		if (actor == PLAYER2)
+			board->incrementRound();
+	}
+	return board->hasWinner() ? board->getCurrentTurn() : NONE;
+}
+
+// Random legal moves (first round rule included) without completing four in a row
+void Tournament::playOpening(Connect4* board, unsigned int opening) {
+	std::mt19937 random(opening);
+	int plies = TOURNAMENT_MIN_OPENING + random() % (TOURNAMENT_MAX_OPENING - TOURNAMENT_MIN_OPENING + 1);
+	for (int i = 0; i < plies; i++) {
+		Actor actor = (board->getCurrentTurn() == PLAYER1) ? PLAYER2 : PLAYER1;
+		int moves[MAX_COLS];
+		int count = 0;
+		for (int col = 0; col < cols; col++) {
+			int row = board->nextRow(col);
+			if (row != -1 && !board->isDominateMove(col) && !board->canWin(actor, col, row)) moves[count++] = col;
+		}
+		if (count == 0) return;
+
+		board->setCurrentTurn(actor);
+		int col = moves[random() % count];
+		board->addDisc(board->nextRow(col), col);
+		if (actor == PLAYER2)
+			board->incrementRound();
+	}
+}
+
+// Bradley-Terry ratings by minorization-maximization, a draw counting as half a win. Every pairing
+// also gets one virtual draw so that an agent without wins or losses keeps a finite rating. The
+// error is the 95% interval from the curvature of the likelihood; ratings average 0
+void Tournament::estimateRatings(std::vector<double>& elo, std::vector<double>& error) {
+	int n = (int)entrants.size();
+	std::vector<std::vector<double>> games(n, std::vector<double>(n, 0));
+	std::vector<double> score(n, 0);
+	for (int i = 0; i < n; i++) {
+		for (int j = 0; j < n; j++) {
+			if (i == j) continue;
+			games[i][j] = total.wins[i][j] + total.wins[j][i] + total.draws[i][j] + 1;
+			score[i] += total.wins[i][j] + 0.5 * (total.draws[i][j] + 1);
+		}
+	}
+
+	std::vector<double> strength(n, 1);
+	for (int iteration = 0; iteration < 1000; iteration++) {
+		double logSum = 0;
+		for (int i = 0; i < n; i++) {
+			double denominator = 0;
+			for (int j = 0; j < n; j++)
+				if (i != j) denominator += games[i][j] / (strength[i] + strength[j]);
+			strength[i] = score[i] / denominator;
+			logSum += std::log(strength[i]);
+		}
+		double mean = std::exp(logSum / n);
+		for (int i = 0; i < n; i++)
+			strength[i] /= mean;
+	}
+
+	double eloPerNat = 400 / std::log(10.0);
+	elo.assign(n, 0);
+	error.assign(n, 0);
+	for (int i = 0; i < n; i++) {
+		double information = 0;
+		for (int j = 0; j < n; j++) {
+			if (i == j) continue;
+			double p = strength[i] / (strength[i] + strength[j]);
+			information += games[i][j] * p * (1 - p);
+		}
+		elo[i] = eloPerNat * std::log(strength[i]);
+		error[i] = (information > 0) ? 1.96 * eloPerNat / std::sqrt(information) : 0;
+	}
+}
+
+void Tournament::printResults() {
+	int n = (int)entrants.size();
+	size_t width = 8;
+	for (Entrant& entrant : entrants)
+		width = std::max(width, entrant.spec.size() + 2);
+
+	// Results of the row agent against the column agent as wins-draws-losses
+	std::cout << std::endl << std::left << std::setw(width) << "W-D-L";
+	for (int j = 0; j < n; j++)
+		std::cout << std::setw(width) << entrants[j].spec;
+	std::cout << std::endl;
+	for (int i = 0; i < n; i++) {
+		std::cout << std::setw(width) << entrants[i].spec;
+		for (int j = 0; j < n; j++) {
+			std::string cell = (i == j) ? "-" : std::to_string(total.wins[i][j]) + "-" + std::to_string(total.draws[i][j]) + "-" + std::to_string(total.wins[j][i]);
+			std::cout << std::setw(width) << cell;
+		}
+		std::cout << std::endl;
+	}
+
+	std::vector<double> elo, error;
+	estimateRatings(elo, error);
+	std::cout << std::endl << std::setw(width) << "Agent" << std::right << std::setw(8) << "Games" << std::setw(9) << "Score"
+		<< std::setw(16) << "Elo (95%)" << std::setw(12) << "ms/move" << std::endl;
+	for (int i = 0; i < n; i++) {
+		int played = 0;
+		double points = 0;
+		for (int j = 0; j < n; j++) {
+			played += total.wins[i][j] + total.wins[j][i] + total.draws[i][j];
+			points += total.wins[i][j] + 0.5 * total.draws[i][j];
+		}
+		std::ostringstream rating;
+		rating << std::fixed << std::setprecision(0) << std::showpos << elo[i] << std::noshowpos << " +/- " << error[i];
+		std::cout << std::left << std::setw(width) << entrants[i].spec << std::right << std::setw(8) << played
+			<< std::setw(8) << std::fixed << std::setprecision(1) << (played ? 100 * points / played : 0) << "%"
+			<< std::setw(16) << rating.str()
+			<< std::setw(12) << std::setprecision(2) << (total.moves[i] ? total.moveMs[i] / total.moves[i] : 0) << std::endl;
+	}
+}
@@ -0,0 +1,68 @@
+// 
+// tournament.h
+// Jake Buhite and Nick Abegg
+// 10/26/2023
+//
+#pragma once
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include "agent.h"
+#include "connect-four.h"
+#include "tablebase.h"
+#include "tdl-agent.h"
+
+constexpr auto TOURNAMENT_TABLE_MB = 16; // Transposition table of each MiniMax entrant
+constexpr auto TOURNAMENT_MIN_OPENING = 2; // Random plies played before the agents take over
+constexpr auto TOURNAMENT_MAX_OPENING = 4;
+
+// Headless round robin between agents given as specs: minimax:<depth>, mcts:<iterations>,
+// solver or tdl:<player 1 weights>:<player 2 weights>. Every pairing plays each random
+// opening twice with the colours swapped; games are spread over a pool of threads, each
+// with its own board and agent instances
+class Tournament {
+private:
+	struct Entrant {
+		std::string spec;
+		std::string kind;
+		int strength = 0;
+		std::unique_ptr<TDLAgent> tables[3]; // Weights shared by every thread's TDL agents
+	};
+
+	struct Game {
+		int entrant[3]; // Entrant playing each colour
+		unsigned int opening;
+	};
+
+	// Totals from one thread, merged once it finishes
+	struct Tally {
+		std::vector<std::vector<int>> wins;
+		std::vector<std::vector<int>> draws;
+		std::vector<double> moveMs;
+		std::vector<long long> moves;
+	};
+
+	int rows;
+	int cols;
+	unsigned int seed = 2023;
+	Tablebase* tablebase = nullptr;
+	std::vector<Entrant> entrants;
+	std::vector<Game> schedule;
+	std::atomic<int> nextGame{ 0 };
+	Tally total;
+
+	void worker(int index, Tally* tally);
+	Agent* createAgent(int entrant, Connect4* board, Actor actor, int index);
+	Actor playGame(Connect4* board, const Game& game, Agent* agents[3], Tally* tally);
+	void playOpening(Connect4* board, unsigned int opening);
+	void estimateRatings(std::vector<double>& elo, std::vector<double>& error);
+public:
+	Tournament(int rows, int cols);
+
+	bool addEntrant(const std::string& spec);
+	void setSeed(unsigned int seed);
+	void setTablebase(Tablebase* tablebase);
+	void run(int gamesPerPairing, int threads);
+	void printResults();
+};
@@ -0,0 +1,57 @@
+// 
+// transposition-table.cpp
+// Jake Buhite and Nick Abegg
+// 10/26/2023
+//
+#include "transposition-table.h"
+
+TranspositionTable::TranspositionTable() : TranspositionTable(32) {}
+
+TranspositionTable::TranspositionTable(size_t megabytes) { resize(megabytes); }
+
+void TranspositionTable::resize(size_t megabytes) {
+	// Round the budget down to a power of two number of slots
+	count = 1;
+	while (count * 2 * sizeof(Slot) <= megabytes * 1024 * 1024)
+		count *= 2;
+	slots.reset(new Slot[count]);
+	indexMask = count - 1;
+	clear();
+}
+
+void TranspositionTable::clear() {
+	for (size_t i = 0; i < count; i++) {
+		slots[i].keyXorData.store(0, std::memory_order_relaxed);
+		slots[i].data.store(0, std::memory_order_relaxed);
+	}
+}
+
+size_t TranspositionTable::indexOf(uint64_t key) { return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 20) & indexMask; }
+
+bool TranspositionTable::probe(uint64_t key, TTEntry& entry) {
+	Slot& slot = slots[indexOf(key)];
+	uint64_t data = slot.data.load(std::memory_order_relaxed);
+	uint64_t keyXorData = slot.keyXorData.load(std::memory_order_relaxed);
+	if ((keyXorData ^ data) != key || data == 0) return false;
+
+	// Data layout: score (32 bits) | depth (8) | bound (8) | move + 1 (8)
+	entry.score = (int32_t)(uint32_t)(data >> 32);
+	entry.depth = (int)((data >> 24) & 0xFF);
+	entry.bound = (Bound)((data >> 16) & 0xFF);
+	entry.move = (int)((data >> 8) & 0xFF) - 1;
+	return true;
+}
+
+void TranspositionTable::store(uint64_t key, int score, int depth, Bound bound, int move) {
+	Slot& slot = slots[indexOf(key)];
+
+	// Keep a deeper result for the same position, otherwise always replace
+	uint64_t old = slot.data.load(std::memory_order_relaxed);
+	if ((slot.keyXorData.load(std::memory_order_relaxed) ^ old) == key && old != 0 && (int)((old >> 24) & 0xFF) > depth) return;
+
+	uint64_t data = ((uint64_t)(uint32_t)score << 32) | ((uint64_t)(depth & 0xFF) << 24) | ((uint64_t)bound << 16) | ((uint64_t)((move + 1) & 0xFF) << 8);
+	slot.keyXorData.store(key ^ data, std::memory_order_relaxed);
+	slot.data.store(data, std::memory_order_relaxed);
+}
+
+size_t TranspositionTable::getSize() { return count; }
\ No newline at end of file
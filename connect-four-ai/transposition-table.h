@@ -0,0 +1,44 @@
+// 
+// transposition-table.h
+// Jake Buhite and Nick Abegg
+// 10/26/2023
+//
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+enum Bound { BOUND_NONE = 0, BOUND_EXACT = 1, BOUND_LOWER = 2, BOUND_UPPER = 3 };
+
+struct TTEntry {
+	int score;
+	int depth;
+	Bound bound;
+	int move;
+};
+
+// Fixed-size, power-of-two table of search results keyed by Connect4::getKey().
+// Lock-free for concurrent searches: each slot stores key ^ data next to data, so a
+// slot torn by two writers fails the key check on probe instead of returning garbage
+class TranspositionTable {
+private:
+	struct Slot {
+		std::atomic<uint64_t> keyXorData;
+		std::atomic<uint64_t> data;
+	};
+
+	std::unique_ptr<Slot[]> slots;
+	size_t count;
+	uint64_t indexMask;
+
+	size_t indexOf(uint64_t key);
+public:
+	TranspositionTable();
+	TranspositionTable(size_t megabytes);
+
+	void resize(size_t megabytes);
+	void clear();
+	bool probe(uint64_t key, TTEntry& entry);
+	void store(uint64_t key, int score, int depth, Bound bound, int move);
+	size_t getSize();
+};
\ No newline at end of file
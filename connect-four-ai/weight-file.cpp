@@ -0,0 +1,106 @@
+// 
+// weight-file.cpp
+// Jake Buhite and Nick Abegg
+// 10/26/2023
+//
+#include "weight-file.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+static const char WEIGHT_MAGIC[4] = { 'C', '4', 'T', 'D' };
+static const uint32_t WEIGHT_VERSION = 1;
+
+bool WeightFile::load(const std::string& fileName) {
+	header = nullptr;
+	if (!file.open(fileName)) return false;
+
+	// Validate the header, the size of the weight block and its checksum
+	const WeightHeader* h = (const WeightHeader*)file.data();
+	if (file.size() < sizeof(WeightHeader) || std::memcmp(h->magic, WEIGHT_MAGIC, 4) != 0 || h->version != WEIGHT_VERSION
+		|| typeSize(h->type) == 0 || h->count != (uint64_t)h->numTuples * h->weightsPerTuple
+		|| file.size() < sizeof(WeightHeader) + scalesSize(h->type, h->numTuples) + h->count * typeSize(h->type)) {
+		std::cout << "Invalid weight file " << fileName << std::endl;
+		file.close();
+		return false;
+	}
+	if (checksum(h + 1, scalesSize(h->type, h->numTuples) + h->count * typeSize(h->type)) != h->checksum) {
+		std::cout << "Checksum mismatch in weight file " << fileName << std::endl;
+		file.close();
+		return false;
+	}
+
+	header = h;
+	return true;
+}
+
+const WeightHeader* WeightFile::getHeader() { return header; }
+
+const float* WeightFile::getScales() {
+	return (header == nullptr || header->type != WEIGHT_INT16) ? nullptr : (const float*)(header + 1);
+}
+
+const void* WeightFile::getData() {
+	return (header == nullptr) ? nullptr : (const char*)(header + 1) + scalesSize(header->type, header->numTuples);
+}
+
+bool WeightFile::isWeightFile(const std::string& fileName) {
+	char magic[4] = {};
+	std::ifstream in(fileName, std::ios::in | std::ios::binary);
+	in.read(magic, 4);
+	return !in.fail() && std::memcmp(magic, WEIGHT_MAGIC, 4) == 0;
+}
+
+bool WeightFile::save(const std::string& fileName, uint32_t numTuples, uint32_t tupleLength, uint32_t weightsPerTuple,
+	WeightType type, const void* data, uint64_t count, const float* scales) {
+	std::ofstream out(fileName, std::ios::out | std::ios::binary);
+	if (out.fail()) {
+		std::cout << "Could not open " << fileName << std::endl;
+		return false;
+	}
+
+	WeightHeader header;
+	std::memcpy(header.magic, WEIGHT_MAGIC, 4);
+	header.version = WEIGHT_VERSION;
+	header.numTuples = numTuples;
+	header.tupleLength = tupleLength;
+	header.weightsPerTuple = weightsPerTuple;
+	header.type = type;
+	header.count = count;
+	header.checksum = checksum(data, count * typeSize(type), checksum(scales, scalesSize(type, numTuples)));
+	out.write((const char*)&header, sizeof(header));
+	out.write((const char*)scales, scalesSize(type, numTuples));
+	out.write((const char*)data, count * typeSize(type));
+	return !out.fail();
+}
+
+size_t WeightFile::typeSize(uint32_t type) {
+	switch (type) {
+	case WEIGHT_FLOAT64:
+		return sizeof(double);
+	case WEIGHT_FLOAT16:
+	case WEIGHT_INT16:
+		return sizeof(uint16_t);
+	default:
+		return 0;
+	}
+}
+
+size_t WeightFile::scalesSize(uint32_t type, uint32_t numTuples) {
+	return (type == WEIGHT_INT16) ? numTuples * sizeof(float) : 0;
+}
+
+// FNV-1a over 8 byte words (then the trailing bytes), fast enough to check on every load.
+// Pass a previous result as hash to checksum consecutive blocks
+uint64_t WeightFile::checksum(const void* data, size_t length, uint64_t hash) {
+	const unsigned char* bytes = (const unsigned char*)data;
+	size_t i = 0;
+	for (; i + 8 <= length; i += 8) {
+		uint64_t word;
+		std::memcpy(&word, bytes + i, 8);
+		hash = (hash ^ word) * 1099511628211ULL;
+	}
+	for (; i < length; i++)
+		hash = (hash ^ bytes[i]) * 1099511628211ULL;
+	return hash;
+}
@@ -0,0 +1,92 @@
+// 
+// weight-file.h
+// Jake Buhite and Nick Abegg
+// 10/26/2023
+//
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include "mapped-file.h"
+
+// Element type of the stored weights
+enum WeightType : uint32_t {
+	WEIGHT_FLOAT64 = 0,
+	WEIGHT_FLOAT16 = 1,
+	WEIGHT_INT16 = 2 // Scaled per tuple: weight = value * scale[tuple]
+};
+
+// Weight file: header, then (int16 only) one float scale per tuple, then count weights
+// of the given type, tuple by tuple. The header is a multiple of 8 bytes so the mapped
+// weights stay aligned
+struct WeightHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t numTuples;
+	uint32_t tupleLength;
+	uint32_t weightsPerTuple;
+	uint32_t type;
+	uint64_t count;
+	uint64_t checksum;
+};
+
+// Read-only, memory mapped view of a binary weight file
+class WeightFile {
+private:
+	MappedFile file;
+	const WeightHeader* header = nullptr;
+public:
+	bool load(const std::string& fileName);
+	const WeightHeader* getHeader();
+	const float* getScales();
+	const void* getData();
+
+	static bool isWeightFile(const std::string& fileName);
+	static bool save(const std::string& fileName, uint32_t numTuples, uint32_t tupleLength, uint32_t weightsPerTuple,
+		WeightType type, const void* data, uint64_t count, const float* scales = nullptr);
+	static size_t typeSize(uint32_t type);
+	static size_t scalesSize(uint32_t type, uint32_t numTuples);
+	static uint64_t checksum(const void* data, size_t length, uint64_t hash = 14695981039346656037ULL);
+};
+
+// IEEE 754 half precision conversions, inline since they run once per weight lookup
+inline float halfToFloat(uint16_t half) {
+	uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+	uint32_t exponent = (half >> 10) & 0x1F;
+	uint32_t mantissa = half & 0x3FF;
+	uint32_t bits;
+	if (exponent == 0x1F) bits = sign | 0x7F800000 | (mantissa << 13);
+	else if (exponent != 0) bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	else if (mantissa == 0) bits = sign;
+	else {
+		// Subnormal half, normalize it for the float exponent
+		exponent = 113;
+		while ((mantissa & 0x400) == 0) {
+			mantissa <<= 1;
+			exponent--;
+		}
+		bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+	}
+	float value;
+	std::memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+inline uint16_t floatToHalf(float value) {
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	uint32_t sign = (bits >> 16) & 0x8000;
+	int exponent = (int)((bits >> 23) & 0xFF) - 127 + 15;
+	uint32_t mantissa = bits & 0x7FFFFF;
+	if (exponent >= 31) return (uint16_t)(sign | 0x7C00);
+	if (exponent <= 0) {
+		// Too small for a normal half: round to a subnormal or to zero
+		if (exponent < -10) return (uint16_t)sign;
+		mantissa |= 0x800000;
+		int shift = 14 - exponent;
+		uint32_t half = (mantissa >> shift) + ((mantissa >> (shift - 1)) & 1);
+		return (uint16_t)(sign | half);
+	}
+	// Rounding may carry into the exponent, which is still the correct result
+	return (uint16_t)((sign | ((uint32_t)exponent << 10) | (mantissa >> 13)) + ((mantissa >> 12) & 1));
+}
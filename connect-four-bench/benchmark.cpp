@@ -0,0 +1,118 @@
+// 
+// benchmark.cpp
+// Jake Buhite and Nick Abegg
+// 10/26/2023
+//
+// Microbenchmarks for the board primitives: ns/op and heap allocations/op
+// over a corpus of random legal positions.
+//
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "../connect-four-ai/alloc-counter.h"
+#include "../connect-four-ai/connect-four.h"
+#include "../connect-four-ai/minimax.h"
+#include "../connect-four-ai/tdl-agent.h"
+
+// Results are folded in here so the compiler cannot drop the measured calls
+static volatile long long sink = 0;
+
+// Random positions reached by legal play, each with moves left and no winner yet
+std::vector<Connect4*> buildCorpus(int count, unsigned int seed) {
+	std::mt19937 random(seed);
+	std::vector<Connect4*> corpus;
+	while ((int)corpus.size() < count) {
+		Connect4* board = new Connect4();
+		int plies = random() % 36;
+		bool over = false;
+		for (int i = 0; i < plies && !over; i++) {
+			int col;
+			do col = random() % board->getCols(); while (board->nextRow(col) == -1);
+			board->addDisc(board->nextRow(col), col, (i % 2 == 0) ? PLAYER1 : PLAYER2);
+			over = board->hasWinner() || board->isDraw();
+		}
+		if (over) {
+			delete board;
+			continue;
+		}
+		corpus.push_back(board);
+	}
+	return corpus;
+}
+
+// Runs op over the whole corpus for the given number of rounds; opsPerBoard is the
+// number of primitive calls op makes per position
+template <typename Op>
+void measure(const std::string& name, std::vector<Connect4*>& corpus, int rounds, int opsPerBoard, Op op) {
+	// One warm-up pass so lazily built tables and caches are not charged to the primitive
+	for (Connect4* board : corpus) sink = sink + op(board);
+
+	long long allocationsBefore = totalAllocations();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; round++)
+		for (Connect4* board : corpus)
+			sink = sink + op(board);
+	double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	long long allocated = totalAllocations() - allocationsBefore;
+
+	double ops = (double)rounds * corpus.size() * opsPerBoard;
+	std::printf("%-28s %10.1f ns/op %8.2f allocs/op\n", name.c_str(), elapsed / ops, allocated / ops);
+}
+
+int main(int argc, char* argv[]) {
+	int positions = (argc >= 2) ? std::atoi(argv[1]) : 10000;
+	int rounds = (argc >= 3) ? std::atoi(argv[2]) : 20;
+	std::vector<Connect4*> corpus = buildCorpus(positions, 2023);
+	TDLAgent agent(false, PLAYER1, 0, 0);
+	std::printf("%d positions, %d rounds\n", positions, rounds);
+
+	measure("Connect4::nextRow", corpus, rounds, 7, [](Connect4* board) {
+		long long sum = 0;
+		for (int col = 0; col < 7; col++) sum += board->nextRow(col);
+		return sum;
+	});
+
+	measure("Connect4::hasWinner", corpus, rounds, 1, [](Connect4* board) {
+		return (long long)board->hasWinner();
+	});
+
+	measure("Connect4::canWin", corpus, rounds, 7, [](Connect4* board) {
+		long long sum = 0;
+		for (int col = 0; col < 7; col++) {
+			int row = board->nextRow(col);
+			if (row != -1) sum += board->canWin(PLAYER1, col, row);
+		}
+		return sum;
+	});
+
+	measure("Connect4::generateTDLMoves", corpus, rounds, 1, [](Connect4* board) {
+		int moves[MAX_COLS];
+		return (long long)board->generateTDLMoves(moves);
+	});
+
+	// getMirroredField was replaced by the bitboard's mirrored key
+	measure("Connect4::getMirroredKey", corpus, rounds, 1, [](Connect4* board) {
+		return (long long)board->getMirroredKey();
+	});
+
+	measure("TDLAgent::getIndices", corpus, rounds, 1, [&agent](Connect4* board) {
+		int indices[TDL_NUM_INDICES];
+		agent.getIndices(board, indices);
+		return (long long)indices[0];
+	});
+
+	// Whole searches at a fixed depth on a scratch copy of each position, past the first-round restriction
+	Connect4 scratch;
+	scratch.incrementRound();
+	MiniMax searcher(&scratch, 5, PLAYER1);
+	measure("MiniMax::getAgentMove", corpus, 1, 1, [&scratch, &searcher](Connect4* board) {
+		scratch.setBoard(board);
+		return (long long)searcher.getAgentMove();
+	});
+
+	for (Connect4* board : corpus) delete board;
+	return 0;
+}
@@ -0,0 +1,100 @@
+// 
+// tests.cpp
+// Jake Buhite and Nick Abegg
+// 10/26/2023
+//
+// Regression tests for the search. Each check prints its result; the exit code is the
+// number of failed checks.
+//
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "../connect-four-ai/connect-four.h"
+#include "../connect-four-ai/minimax.h"
+#include "../connect-four-ai/tablebase.h"
+
+static int failures = 0;
+
+static void check(bool passed, const std::string& name) {
+	std::printf("%s %s\n", passed ? "PASS" : "FAIL", name.c_str());
+	if (!passed) failures++;
+}
+
+static Actor toMove(Connect4* board) {
+	return ((board->getRows() * board->getCols() - board->getAvailableSpaces()) % 2 == 0) ? PLAYER1 : PLAYER2;
+}
+
+// Exact score of playing col, from the point of view of the player who plays it
+static int moveScore(Connect4* board, Tablebase* tablebase, int col) {
+	int row = board->nextRow(col);
+	board->addDisc(row, col, toMove(board));
+	int score = 0;
+	if (board->hasWinner()) score = 100;
+	else if (!board->isDraw()) {
+		tablebase->lookup(board, score);
+		score = -score;
+	}
+	board->removeDisc(row, col);
+	return score;
+}
+
+// A root position within the tablebase must still get a legal move, and one of the best ones
+static bool searchPicksBestMove(Connect4* board, Tablebase* tablebase, int depth) {
+	MiniMax agent(board, depth, toMove(board));
+	agent.setDepth(depth);
+	agent.setTablebase(tablebase);
+	int move = agent.getAgentMove();
+	if (move < 0 || move >= board->getCols() || board->nextRow(move) == -1) return false;
+
+	int best = -1000;
+	for (int col = 0; col < board->getCols(); col++)
+		if (board->nextRow(col) != -1) best = std::max(best, moveScore(board, tablebase, col));
+	return moveScore(board, tablebase, move) == best;
+}
+
+static void testTablebaseRoot() {
+	const std::string fileName = "test-tablebase.bin";
+	const int maxEmpty = 8;
+	Tablebase tablebase;
+	if (!Tablebase::generate(fileName, maxEmpty, 4, 5) || !tablebase.load(fileName)) {
+		check(false, "tablebase generation");
+		return;
+	}
+
+	Connect4 board(4, 5);
+	board.incrementRound();
+	int moves[] = { 0, 1, 2, 3, 4, 0, 1, 2, 3, 4, 0, 1 };
+	for (int i = 0; i < 12; i++)
+		board.addDisc(board.nextRow(moves[i]), moves[i], (i % 2 == 0) ? PLAYER1 : PLAYER2);
+	bool passed = true;
+	for (int depth = 1; depth <= 8; depth++)
+		passed = passed && searchPicksBestMove(&board, &tablebase, depth);
+	check(passed, "tablebase root: fixed position at depths 1 to 8");
+
+	// Random positions with both players to move
+	std::mt19937 random(2023);
+	int positions = 0;
+	passed = true;
+	while (positions < 200) {
+		Connect4 game(4, 5);
+		game.incrementRound();
+		while (!game.hasWinner() && !game.isDraw() && game.getAvailableSpaces() > maxEmpty - (int)(random() % 4)) {
+			int col;
+			do col = random() % game.getCols(); while (game.nextRow(col) == -1);
+			game.addDisc(game.nextRow(col), col, toMove(&game));
+		}
+		if (game.hasWinner() || game.isDraw()) continue;
+		passed = passed && searchPicksBestMove(&game, &tablebase, 1 + positions % 5);
+		positions++;
+	}
+	check(passed, "tablebase root: 200 random positions");
+	std::remove(fileName.c_str());
+}
+
+int main() {
+	testTablebaseRoot();
+	std::printf("%d failure(s)\n", failures);
+	return failures;
+}